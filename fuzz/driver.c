@@ -0,0 +1,170 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "fuzz.h"
+
+// replays inputs without libFuzzer: "target [-runs=N] <file|dir>...".
+// a directory of directories is a corpus, every subdirectory is one input class,
+// and with -runs the speed of every class is printed
+
+struct input_class
+{
+	char name[256];
+	size_t inputs;
+	size_t bytes;
+	double seconds;
+};
+
+static long runs = 0;
+
+static double _now(void)
+{
+	struct timespec time;
+
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+static int _is_directory(const char *path)
+{
+	struct stat info;
+
+	return stat(path, &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+static void _run_file(const char *path, struct input_class *class)
+{
+	FILE *fp = fopen(path, "rb");
+	if(fp == NULL)
+	{
+		fprintf(stderr, "cannot open %s\n", path);
+		exit(EXIT_FAILURE);
+	}
+
+	uint8_t *data = NULL;
+	size_t size = 0;
+	size_t capacity = 0;
+	size_t count = 0;
+
+	do
+	{
+		if(size == capacity)
+		{
+			capacity = capacity == 0 ? 4096 : capacity * 2;
+
+			if((data = realloc(data, capacity)) == NULL)
+				abort();
+		}
+
+		count = fread(data + size, 1, capacity - size, fp);
+		size += count;
+	} while(count != 0);
+
+	fclose(fp);
+
+	long repeat = runs > 0 ? runs : 1;
+	double start = _now();
+
+	for(long i = 0; i < repeat; i++)
+		LLVMFuzzerTestOneInput(data, size);
+
+	class->seconds += _now() - start;
+	class->bytes += size * repeat;
+	class->inputs++;
+
+	free(data);
+}
+
+static void _run_directory(const char *path, struct input_class *class)
+{
+	DIR *dir = opendir(path);
+	if(dir == NULL)
+		return;
+
+	struct dirent *entry = NULL;
+	char child[4096];
+
+	while((entry = readdir(dir)) != NULL)
+	{
+		if(entry->d_name[0] == '.')
+			continue;
+
+		snprintf(child, sizeof(child), "%s/%s", path, entry->d_name);
+
+		if(!_is_directory(child))
+			_run_file(child, class);
+	}
+
+	closedir(dir);
+}
+
+static void _report(const struct input_class *class)
+{
+	if(runs <= 0 || class->inputs == 0)
+		return;
+
+	double speed = class->seconds > 0 ? class->bytes / class->seconds / (1024 * 1024) : 0;
+
+	printf("%-16s inputs %-6zu bytes %-12zu %8.3f s %10.2f MiB/s\n", class->name, class->inputs, class->bytes, class->seconds, speed);
+}
+
+int main(int argc, char **argv)
+{
+	size_t total = 0;
+
+	for(int i = 1; i < argc; i++)
+	{
+		if(strncmp(argv[i], "-runs=", 6) == 0)
+		{
+			runs = strtol(argv[i] + 6, NULL, 10);
+			continue;
+		}
+
+		struct input_class class = { "", 0, 0, 0 };
+		snprintf(class.name, sizeof(class.name), "%s", argv[i]);
+
+		if(!_is_directory(argv[i]))
+		{
+			_run_file(argv[i], &class);
+			_report(&class);
+			total += class.inputs;
+			continue;
+		}
+
+		// files directly in the directory are one class, subdirectories are classes of their own
+		_run_directory(argv[i], &class);
+		_report(&class);
+		total += class.inputs;
+
+		DIR *dir = opendir(argv[i]);
+		struct dirent *entry = NULL;
+
+		while(dir != NULL && (entry = readdir(dir)) != NULL)
+		{
+			struct input_class subclass = { "", 0, 0, 0 };
+			char child[4096];
+
+			snprintf(child, sizeof(child), "%s/%s", argv[i], entry->d_name);
+
+			if(entry->d_name[0] == '.' || !_is_directory(child))
+				continue;
+
+			snprintf(subclass.name, sizeof(subclass.name), "%s", entry->d_name);
+			_run_directory(child, &subclass);
+			_report(&subclass);
+			total += subclass.inputs;
+		}
+
+		if(dir != NULL)
+			closedir(dir);
+	}
+
+	printf("%zu inputs replayed\n", total);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,152 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "fuzz.h"
+
+int fuzz_load_reference(lc_config_t *config, const uint8_t *data, size_t size)
+{
+	if(lc_init_config(config, NULL, FUZZ_DELIM) == LC_ERROR)
+		abort();
+
+	// fmemopen() refuses empty buffers
+	if(size == 0)
+		return LC_SUCCESS;
+
+	FILE *fp = fmemopen((void *)data, size, "r");
+	if(fp == NULL)
+		abort();
+
+	int result = lc_load_config_stream(config, fp);
+
+	fclose(fp);
+	return result;
+}
+
+char* fuzz_dump(lc_config_t *config, size_t *length)
+{
+	char *buffer = NULL;
+	size_t size = 0;
+
+	FILE *fp = open_memstream(&buffer, &size);
+	if(fp == NULL)
+		abort();
+
+	// dumping an empty config fails with LC_ERR_EMPTY, it is still a valid state
+	if(lc_get_size(config) != 0 && lc_dump_config_stream(config, fp) == LC_ERROR)
+		abort();
+
+	fclose(fp);
+
+	if(length != NULL)
+		*length = size;
+
+	return buffer;
+}
+
+static void _fail(const char *path, const char *what)
+{
+	fprintf(stderr, "[FUZZ] %s: %s differs from the reference loader\n", path, what);
+	abort();
+}
+
+void fuzz_expect_same(lc_config_t *reference, int reference_result,
+	lc_config_t *candidate, int candidate_result, const char *path)
+{
+	size_t reference_line = 0, reference_column = 0;
+	size_t candidate_line = 0, candidate_column = 0;
+
+	if(reference_result != candidate_result)
+		_fail(path, "result");
+
+	if(reference_result == LC_ERROR && reference->error_type != candidate->error_type)
+		_fail(path, "error type");
+
+	lc_get_error_position(reference, &reference_line, &reference_column);
+	lc_get_error_position(candidate, &candidate_line, &candidate_column);
+
+	if(reference_result == LC_ERROR && (reference_line != candidate_line || reference_column != candidate_column))
+		_fail(path, "error position");
+
+	if(lc_get_size(reference) != lc_get_size(candidate))
+		_fail(path, "size");
+
+	size_t reference_length = 0, candidate_length = 0;
+	char *reference_dump = fuzz_dump(reference, &reference_length);
+	char *candidate_dump = fuzz_dump(candidate, &candidate_length);
+
+	if(reference_length != candidate_length || memcmp(reference_dump, candidate_dump, reference_length) != 0)
+		_fail(path, "dump");
+
+	free(reference_dump);
+	free(candidate_dump);
+}
+
+void fuzz_expect_same_variables(lc_config_t *reference, lc_config_t *candidate, const char *path)
+{
+	if(lc_get_size(reference) != lc_get_size(candidate))
+		_fail(path, "size");
+
+	lc_iterator_t *reference_iterator = lc_create_iterator(reference, NULL);
+	lc_iterator_t *candidate_iterator = lc_create_iterator(candidate, NULL);
+
+	if(reference_iterator == NULL || candidate_iterator == NULL)
+		abort();
+
+	const char *reference_name = NULL, *reference_value = NULL;
+	const char *candidate_name = NULL, *candidate_value = NULL;
+
+	while(lc_iterator_next(reference_iterator, &reference_name, &reference_value) == 1)
+	{
+		if(lc_iterator_next(candidate_iterator, &candidate_name, &candidate_value) != 1)
+			_fail(path, "size");
+
+		if(strcmp(reference_name, candidate_name) != 0 || strcmp(reference_value, candidate_value) != 0)
+			_fail(path, "variable");
+	}
+
+	if(lc_iterator_next(candidate_iterator, &candidate_name, &candidate_value) == 1)
+		_fail(path, "size");
+
+	lc_destroy_iterator(reference_iterator);
+	lc_destroy_iterator(candidate_iterator);
+}
+
+uint8_t fuzz_next_byte(struct fuzz_input *input)
+{
+	if(input->position == input->size)
+		return 0;
+
+	return input->data[input->position++];
+}
+
+const char* fuzz_temp_path(void)
+{
+	static char path[64];
+
+	if(path[0] == '\0')
+		snprintf(path, sizeof(path), "/tmp/libconf-fuzz-%ld.conf", (long)getpid());
+
+	return path;
+}
+
+int fuzz_write_file(const char *path, const uint8_t *data, size_t size)
+{
+	FILE *fp = fopen(path, "w");
+	if(fp == NULL)
+		return LC_ERROR;
+
+	if(size != 0 && fwrite(data, 1, size, fp) != size)
+	{
+		fclose(fp);
+		return LC_ERROR;
+	}
+
+	if(fclose(fp) == EOF)
+		return LC_ERROR;
+
+	return LC_SUCCESS;
+}
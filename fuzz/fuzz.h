@@ -0,0 +1,44 @@
+#ifndef FUZZ_H
+#define FUZZ_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "libconf.h"
+
+#define FUZZ_DELIM "="
+
+// entry point of every target, called by libFuzzer or by the replay driver
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+// loads the input through the reference path: lc_load_config_stream() on a memory stream
+int fuzz_load_reference(lc_config_t *config, const uint8_t *data, size_t size);
+
+// dump of the config as a string, "" for an empty config. the result must be freed
+char* fuzz_dump(lc_config_t *config, size_t *length);
+
+// aborts if the candidate differs from the reference in result, error or dump
+void fuzz_expect_same(lc_config_t *reference, int reference_result,
+	lc_config_t *candidate, int candidate_result, const char *path);
+
+// aborts if the candidate doesn't have the same variables in the same order, without dumping them
+void fuzz_expect_same_variables(lc_config_t *reference, lc_config_t *candidate, const char *path);
+
+// input of the targets that make a sequence of calls, read one byte at a time
+struct fuzz_input
+{
+	const uint8_t *data;
+	size_t size;
+	size_t position;
+};
+
+// next byte of the input, 0 once it is used up
+uint8_t fuzz_next_byte(struct fuzz_input *input);
+
+// path of a temporary file owned by this process
+const char* fuzz_temp_path(void);
+
+int fuzz_write_file(const char *path, const uint8_t *data, size_t size);
+
+#endif
@@ -0,0 +1,289 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef LC_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "fuzz.h"
+
+// every other way to get variables into a config is compared with lc_load_config_stream().
+// new load paths (mmap, parallel, lazy...) are added here as one more candidate
+
+static int _load_file(lc_config_t *config, const char *path)
+{
+	if(lc_init_config(config, NULL, FUZZ_DELIM) == LC_ERROR)
+		abort();
+
+	return lc_load_config(config, path);
+}
+
+static int _load_async(lc_config_t *config, const char *path)
+{
+	if(lc_init_config(config, NULL, FUZZ_DELIM) == LC_ERROR)
+		abort();
+
+	lc_async_t *request = lc_load_config_async(config, path, NULL, NULL);
+	if(request == NULL)
+		abort();
+
+	return lc_async_wait(request);
+}
+
+struct _lazy_check
+{
+	lc_config_t *reference;
+	lc_lazy_t *lazy;
+};
+
+static int _compare_lazy_value(const char *name, const char *value, void *data)
+{
+	struct _lazy_check *check = data;
+	const char *decoded = lc_lazy_get(check->lazy, name);
+
+	lc_get_variables(check->reference, &name, 1, &value);
+
+	if(decoded == NULL || value == NULL || strcmp(decoded, value) != 0)
+	{
+		fprintf(stderr, "[FUZZ] lc_lazy_get: \"%s\" differs from the reference loader\n", name);
+		abort();
+	}
+
+	return 0;
+}
+
+// rules on a few short names, so mutated inputs hit them often
+static void _add_rules(lc_config_t *config)
+{
+	if(lc_add_rule(config, "a", LC_TYPE_INTEGER) == LC_ERROR ||
+		lc_add_rule(config, "b", LC_TYPE_BOOLEAN) == LC_ERROR ||
+		lc_add_rule(config, "c", LC_TYPE_SIZE) == LC_ERROR ||
+		lc_add_rule(config, "d", LC_TYPE_STRING) == LC_ERROR ||
+		lc_set_rule_range(config, "d", 0, 8) == LC_ERROR)
+		abort();
+}
+
+// the lazy index must fail where the loader fails, at the same position, and give the same values
+static void _check_lazy(lc_config_t *reference, int reference_result, const char *path, int with_rules)
+{
+	lc_config_t config;
+	size_t reference_line = 0, reference_column = 0, line = 0, column = 0;
+
+	if(lc_init_config(&config, NULL, FUZZ_DELIM) == LC_ERROR)
+		abort();
+
+	if(with_rules)
+		_add_rules(&config);
+
+	struct _lazy_check check = { reference, lc_lazy_open(&config, path) };
+
+	lc_get_error_position(reference, &reference_line, &reference_column);
+	lc_get_error_position(&config, &line, &column);
+
+	if((check.lazy != NULL) != (reference_result == LC_SUCCESS) || line != reference_line || column != reference_column ||
+		(check.lazy == NULL && lc_get_error_type(&config) != lc_get_error_type(reference)))
+	{
+		fprintf(stderr, "[FUZZ] lc_lazy_open: result differs from the reference loader\n");
+		abort();
+	}
+
+	if(check.lazy != NULL)
+	{
+		if(lc_lazy_get_size(check.lazy) != lc_get_size(reference))
+			abort();
+
+		lc_foreach_variable(reference, NULL, _compare_lazy_value, &check);
+		lc_lazy_close(check.lazy);
+	}
+
+	lc_clear_config(&config);
+}
+
+static void _check_file_paths(lc_config_t *reference, int reference_result, const uint8_t *data, size_t size)
+{
+	lc_config_t candidate;
+	const char *path = fuzz_temp_path();
+
+	// lc_load_config() picks the codec by the magic bytes, a stream is always read as text
+	if(size >= 2 && ((data[0] == 0x1f && data[1] == 0x8b) || (data[0] == 0x28 && data[1] == 0xb5)))
+		return;
+
+	if(fuzz_write_file(path, data, size) == LC_ERROR)
+		abort();
+
+	int result = _load_file(&candidate, path);
+	fuzz_expect_same(reference, reference_result, &candidate, result, "lc_load_config");
+	lc_clear_config(&candidate);
+
+	result = _load_async(&candidate, path);
+	fuzz_expect_same(reference, reference_result, &candidate, result, "lc_load_config_async");
+	lc_clear_config(&candidate);
+
+	_check_lazy(reference, reference_result, path, 0);
+
+	// the reference with rules is loaded from the file, which is compared with the stream above
+	if(lc_init_config(&candidate, NULL, FUZZ_DELIM) == LC_ERROR)
+		abort();
+
+	_add_rules(&candidate);
+	result = lc_load_config(&candidate, path);
+	_check_lazy(&candidate, result, path, 1);
+	lc_clear_config(&candidate);
+
+	remove(path);
+}
+
+#ifdef LC_HAVE_ZLIB
+static void _check_gzip(lc_config_t *reference, int reference_result, const uint8_t *data, size_t size)
+{
+	lc_config_t candidate;
+	const char *path = fuzz_temp_path();
+
+	gzFile file = gzopen(path, "wb");
+	if(file == NULL)
+		abort();
+
+	if(size != 0 && gzwrite(file, data, size) != (int)size)
+		abort();
+
+	if(gzclose(file) != Z_OK)
+		abort();
+
+	int result = _load_file(&candidate, path);
+	fuzz_expect_same(reference, reference_result, &candidate, result, "gzip");
+
+	lc_clear_config(&candidate);
+	remove(path);
+}
+#endif
+
+static void _check_clone(lc_config_t *reference)
+{
+	lc_config_t clone;
+
+	if(lc_clone_config(&clone, reference) == LC_ERROR)
+		abort();
+
+	// the clone carries the variables, not the load error
+	fuzz_expect_same(reference, LC_SUCCESS, &clone, LC_SUCCESS, "lc_clone_config");
+	lc_clear_config(&clone);
+}
+
+static void _check_diff(lc_config_t *reference)
+{
+	lc_config_t empty, patched;
+	size_t length = 0;
+	char *buffer = NULL;
+
+	if(lc_init_config(&empty, NULL, FUZZ_DELIM) == LC_ERROR || lc_init_config(&patched, NULL, FUZZ_DELIM) == LC_ERROR)
+		abort();
+
+	lc_diff_t *diff = lc_diff_configs(&empty, reference);
+	if(diff == NULL)
+		abort();
+
+	// the serialized diff is applied, so the diff format is checked too
+	FILE *fp = open_memstream(&buffer, &length);
+	if(fp == NULL || lc_dump_diff_stream(diff, fp) == LC_ERROR)
+		abort();
+
+	fclose(fp);
+	lc_free_diff(diff);
+
+	if(length != 0)
+	{
+		if((fp = fmemopen(buffer, length, "r")) == NULL)
+			abort();
+
+		if((diff = lc_load_diff_stream(fp, FUZZ_DELIM)) == NULL || lc_apply_diff(&patched, diff) == LC_ERROR)
+			abort();
+
+		fclose(fp);
+		lc_free_diff(diff);
+	}
+
+	// duplicate names are not a part of the diff, only the visible values are compared
+	lc_diff_t *rest = lc_diff_configs(reference, &patched);
+	if(rest == NULL || lc_diff_get_size(rest) != 0)
+	{
+		fprintf(stderr, "[FUZZ] lc_apply_diff: differs from the reference loader\n");
+		abort();
+	}
+
+	lc_free_diff(rest);
+	free(buffer);
+	lc_clear_config(&patched);
+	lc_clear_config(&empty);
+}
+
+struct _shm_check
+{
+	lc_config_t *reference;
+	lc_shm_t *shm;
+};
+
+// duplicate names are passed to the callback too, the lookup gives the value that wins
+static int _compare_shm_value(const char *name, const char *value, void *data)
+{
+	struct _shm_check *check = data;
+	const char *published = lc_shm_get(check->shm, name);
+
+	(void)value;
+	lc_get_variables(check->reference, &name, 1, &value);
+
+	if(published == NULL || value == NULL || strcmp(published, value) != 0)
+	{
+		fprintf(stderr, "[FUZZ] lc_shm_get: \"%s\" differs from the reference loader\n", name);
+		abort();
+	}
+
+	return 0;
+}
+
+static void _check_shm(lc_config_t *reference)
+{
+	char name[64];
+
+	snprintf(name, sizeof(name), "/libconf-fuzz-%ld", (long)getpid());
+
+	if(lc_publish_config(reference, name) == LC_ERROR)
+		abort();
+
+	struct _shm_check check = { reference, lc_shm_attach(name) };
+	if(check.shm == NULL)
+		abort();
+
+	if(lc_shm_get_size(check.shm) != lc_get_size(reference))
+		abort();
+
+	lc_foreach_variable(reference, NULL, _compare_shm_value, &check);
+
+	lc_shm_detach(check.shm);
+	lc_unpublish_config(name);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	lc_config_t reference;
+
+	int result = fuzz_load_reference(&reference, data, size);
+
+	_check_file_paths(&reference, result, data, size);
+#ifdef LC_HAVE_ZLIB
+	_check_gzip(&reference, result, data, size);
+#endif
+	_check_clone(&reference);
+
+	if(result == LC_SUCCESS)
+	{
+		_check_diff(&reference);
+		_check_shm(&reference);
+	}
+
+	lc_clear_config(&reference);
+	return 0;
+}
@@ -0,0 +1,29 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "fuzz.h"
+
+// every loaded variable must be dumped on its own line
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	lc_config_t config;
+	size_t length = 0;
+	size_t lines = 0;
+
+	fuzz_load_reference(&config, data, size);
+
+	char *dump = fuzz_dump(&config, &length);
+
+	for(size_t i = 0; i < length; i++)
+	{
+		if(dump[i] == '\n')
+			lines++;
+	}
+
+	if(lines != lc_get_size(&config))
+		abort();
+
+	free(dump);
+	lc_clear_config(&config);
+	return 0;
+}
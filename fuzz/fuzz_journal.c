@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fuzz.h"
+
+// the input is a sequence of changes to a config with an open journal. the snapshot and the journal
+// are then loaded into a new config, that must have the same variables in the same order
+
+#define JOURNAL_NAMES 8
+// all variables share a few names, so their lookups get slower as the config grows
+#define JOURNAL_CAPACITY 512
+#define JOURNAL_VALUE 8
+#define JOURNAL_STAGED 8
+// a compaction syncs the snapshot, so long inputs would spend their time waiting on the disk
+#define JOURNAL_COMPACTIONS 4
+
+// values use the characters the journal escapes and the separator
+static const char value_characters[] = "ab=\\\n #";
+
+static const char* _journal_path(void)
+{
+	static char path[80];
+
+	if(path[0] == '\0')
+		snprintf(path, sizeof(path), "%s.journal", fuzz_temp_path());
+
+	return path;
+}
+
+static void _read_name(struct fuzz_input *input, char *name)
+{
+	name[0] = 'a' + fuzz_next_byte(input) % JOURNAL_NAMES;
+	name[1] = '\0';
+}
+
+static void _read_value(struct fuzz_input *input, char *value)
+{
+	size_t length = fuzz_next_byte(input) % (JOURNAL_VALUE + 1);
+
+	for(size_t i = 0; i < length; i++)
+		value[i] = value_characters[fuzz_next_byte(input) % (sizeof(value_characters) - 1)];
+
+	value[length] = '\0';
+}
+
+static void _run_transaction(struct fuzz_input *input, lc_config_t *config)
+{
+	size_t count = fuzz_next_byte(input) % (JOURNAL_STAGED + 1);
+
+	lc_transaction_t *transaction = lc_begin_transaction(config);
+	if(transaction == NULL)
+		abort();
+
+	for(size_t i = 0; i < count; i++)
+	{
+		char name[2], value[JOURNAL_VALUE + 1];
+		uint8_t call = fuzz_next_byte(input) % 3;
+		int result = LC_SUCCESS;
+
+		_read_name(input, name);
+		_read_value(input, value);
+
+		if(call == 0 && lc_get_size(config) < JOURNAL_CAPACITY)
+			result = lc_transaction_add(transaction, name, value);
+		else if(call == 1)
+			result = lc_transaction_set(transaction, name, value);
+		else
+			result = lc_transaction_delete(transaction, name);
+
+		if(result == LC_ERROR)
+			abort();
+	}
+
+	// a set or delete of a missing name fails the commit, which writes nothing
+	lc_commit_transaction(transaction);
+}
+
+// changes that fail, like a set of a missing name, must not be journaled either
+static void _run_change(struct fuzz_input *input, lc_config_t *config, uint8_t call)
+{
+	char name[2], new_name[2], value[JOURNAL_VALUE + 1];
+	lc_config_variable_t *variable = NULL;
+
+	_read_name(input, name);
+	_read_name(input, new_name);
+	_read_value(input, value);
+
+	switch(call)
+	{
+	case 0:
+		if(lc_get_size(config) >= JOURNAL_CAPACITY)
+			break;
+
+		if((variable = lc_create_variable(name, value)) == NULL || lc_add_variable(config, variable) == LC_ERROR)
+			abort();
+		break;
+	case 1:
+		lc_set_variable(config, name, value);
+		break;
+	case 2:
+		lc_delete_variable(config, name);
+		break;
+	case 3:
+		if((variable = lc_create_variable(new_name, value)) == NULL)
+			abort();
+
+		lc_replace_variable(config, name, variable);
+		break;
+	}
+
+	if(variable != NULL)
+		lc_destroy_variable(variable);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	struct fuzz_input input = { data, size, 0 };
+	lc_config_t config, replayed;
+	const char *path = fuzz_temp_path();
+	int snapshot = 0;
+	int compactions = 0;
+
+	remove(path);
+	remove(_journal_path());
+
+	if(lc_init_config(&config, path, FUZZ_DELIM) == LC_ERROR || lc_open_journal(&config, _journal_path()) == LC_ERROR)
+		abort();
+
+	while(input.position < input.size)
+	{
+		uint8_t call = fuzz_next_byte(&input) % 16;
+
+		if(call < 12)
+			_run_change(&input, &config, call % 4);
+		else if(call < 15)
+			_run_transaction(&input, &config);
+		else if(lc_get_size(&config) != 0 && compactions++ < JOURNAL_COMPACTIONS)
+		{
+			if(lc_compact_journal(&config) == LC_ERROR)
+				abort();
+
+			snapshot = 1;
+		}
+	}
+
+	lc_close_journal(&config);
+
+	if(lc_init_config(&replayed, path, FUZZ_DELIM) == LC_ERROR)
+		abort();
+
+	if(snapshot && lc_load_config(&replayed, path) == LC_ERROR)
+		abort();
+
+	if(lc_open_journal(&replayed, _journal_path()) == LC_ERROR)
+		abort();
+
+	fuzz_expect_same_variables(&config, &replayed, "journal replay");
+
+	lc_clear_config(&replayed);
+	lc_clear_config(&config);
+	remove(path);
+	remove(_journal_path());
+	return 0;
+}
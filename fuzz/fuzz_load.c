@@ -0,0 +1,33 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "fuzz.h"
+
+static int _count_variable(const char *name, const char *value, void *data)
+{
+	(void)name;
+	(void)value;
+
+	(*(size_t *)data)++;
+	return 0;
+}
+
+// the loader must not crash, and a failed load must leave the config empty
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	lc_config_t config;
+	size_t count = 0;
+
+	int result = fuzz_load_reference(&config, data, size);
+
+	if(result == LC_ERROR && lc_get_size(&config) != 0)
+		abort();
+
+	lc_foreach_variable(&config, NULL, _count_variable, &count);
+
+	if(count != lc_get_size(&config))
+		abort();
+
+	lc_clear_config(&config);
+	return 0;
+}
@@ -0,0 +1,339 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fuzz.h"
+
+// the input is a sequence of calls on two configs, that are checked after every call against a
+// plain list of variables: duplicates are kept in order, and set, delete and replace change the
+// first variable of a name
+
+#define MODEL_CONFIGS 2
+#define MODEL_NAMES 8
+#define MODEL_CAPACITY 512
+#define MODEL_VALUE 8
+#define MODEL_STAGED 8
+
+struct _model_variable
+{
+	char name[2];
+	char value[MODEL_VALUE + 1];
+};
+
+struct _model
+{
+	struct _model_variable variables[MODEL_CAPACITY];
+	size_t count;
+};
+
+static struct _model models[MODEL_CONFIGS];
+
+static void _fail(const char *call)
+{
+	fprintf(stderr, "[FUZZ] %s: differs from the model\n", call);
+	abort();
+}
+
+// a few one letter names, so calls hit the same variables often
+static void _read_name(struct fuzz_input *input, char *name)
+{
+	name[0] = 'a' + fuzz_next_byte(input) % MODEL_NAMES;
+	name[1] = '\0';
+}
+
+static void _read_value(struct fuzz_input *input, char *value)
+{
+	size_t length = 1 + fuzz_next_byte(input) % MODEL_VALUE;
+
+	for(size_t i = 0; i < length; i++)
+		value[i] = 'a' + fuzz_next_byte(input) % 26;
+
+	value[length] = '\0';
+}
+
+static size_t _model_find(const struct _model *model, const char *name)
+{
+	for(size_t i = 0; i < model->count; i++)
+	{
+		if(strcmp(model->variables[i].name, name) == 0)
+			return i;
+	}
+
+	return model->count;
+}
+
+static void _model_add(struct _model *model, const char *name, const char *value)
+{
+	strcpy(model->variables[model->count].name, name);
+	strcpy(model->variables[model->count].value, value);
+	model->count++;
+}
+
+static void _model_delete(struct _model *model, size_t index)
+{
+	memmove(&model->variables[index], &model->variables[index + 1], (model->count - index - 1) * sizeof(struct _model_variable));
+	model->count--;
+}
+
+static void _check(lc_config_t *config, const struct _model *model)
+{
+	if(lc_get_size(config) != model->count)
+		_fail("lc_get_size");
+
+	lc_iterator_t *iterator = lc_create_iterator(config, NULL);
+	if(iterator == NULL)
+		abort();
+
+	const char *name = NULL, *value = NULL;
+	size_t index = 0;
+
+	while(lc_iterator_next(iterator, &name, &value) == 1)
+	{
+		if(index == model->count || strcmp(name, model->variables[index].name) != 0 ||
+			strcmp(value, model->variables[index].value) != 0)
+			_fail("lc_iterator_next");
+
+		index++;
+	}
+
+	lc_destroy_iterator(iterator);
+
+	if(index != model->count)
+		_fail("lc_iterator_next");
+
+	// a lookup gives the first variable of the name
+	for(size_t i = 0; i < MODEL_NAMES; i++)
+	{
+		char name_of[2] = { 'a' + i, '\0' };
+		const char *names[] = { name_of };
+		size_t found = _model_find(model, name_of);
+
+		value = NULL;
+		lc_get_variables(config, names, 1, &value);
+
+		if((value != NULL) != (found != model->count) ||
+			(value != NULL && strcmp(value, model->variables[found].value) != 0))
+			_fail("lc_get_variables");
+	}
+}
+
+static void _run_add(struct fuzz_input *input, lc_config_t *config, struct _model *model)
+{
+	char name[2], value[MODEL_VALUE + 1];
+
+	_read_name(input, name);
+	_read_value(input, value);
+
+	if(model->count == MODEL_CAPACITY)
+		return;
+
+	lc_config_variable_t *variable = lc_create_variable(name, value);
+	if(variable == NULL)
+		abort();
+
+	if(lc_add_variable(config, variable) == LC_ERROR)
+		_fail("lc_add_variable");
+
+	lc_destroy_variable(variable);
+	_model_add(model, name, value);
+}
+
+static void _run_set(struct fuzz_input *input, lc_config_t *config, struct _model *model)
+{
+	char name[2], value[MODEL_VALUE + 1];
+
+	_read_name(input, name);
+	_read_value(input, value);
+
+	size_t index = _model_find(model, name);
+	int result = lc_set_variable(config, name, value);
+
+	if((result == LC_SUCCESS) != (index != model->count))
+		_fail("lc_set_variable");
+
+	if(result == LC_SUCCESS)
+		strcpy(model->variables[index].value, value);
+}
+
+static void _run_delete(struct fuzz_input *input, lc_config_t *config, struct _model *model)
+{
+	char name[2];
+
+	_read_name(input, name);
+
+	size_t index = _model_find(model, name);
+	int result = lc_delete_variable(config, name);
+
+	if((result == LC_SUCCESS) != (index != model->count))
+		_fail("lc_delete_variable");
+
+	if(result == LC_SUCCESS)
+		_model_delete(model, index);
+}
+
+static void _run_replace(struct fuzz_input *input, lc_config_t *config, struct _model *model)
+{
+	char name[2], new_name[2], value[MODEL_VALUE + 1];
+
+	_read_name(input, name);
+	_read_name(input, new_name);
+	_read_value(input, value);
+
+	lc_config_variable_t *variable = lc_create_variable(new_name, value);
+	if(variable == NULL)
+		abort();
+
+	size_t index = _model_find(model, name);
+	int result = lc_replace_variable(config, name, variable);
+
+	lc_destroy_variable(variable);
+
+	if((result == LC_SUCCESS) != (index != model->count))
+		_fail("lc_replace_variable");
+
+	if(result == LC_SUCCESS)
+	{
+		strcpy(model->variables[index].name, new_name);
+		strcpy(model->variables[index].value, value);
+	}
+}
+
+// the staged calls are applied to a copy of the model, a set or delete of a missing name fails the
+// whole transaction
+static void _run_transaction(struct fuzz_input *input, lc_config_t *config, struct _model *model)
+{
+	static struct _model staged;
+	size_t count = fuzz_next_byte(input) % (MODEL_STAGED + 1);
+	int rollback = fuzz_next_byte(input) % 8 == 0;
+	int valid = 1;
+
+	lc_transaction_t *transaction = lc_begin_transaction(config);
+	if(transaction == NULL)
+		abort();
+
+	staged = *model;
+
+	for(size_t i = 0; i < count; i++)
+	{
+		char name[2], value[MODEL_VALUE + 1];
+		uint8_t call = fuzz_next_byte(input) % 3;
+		int result = LC_SUCCESS;
+
+		_read_name(input, name);
+
+		size_t index = _model_find(&staged, name);
+
+		if(call == 0)
+		{
+			_read_value(input, value);
+
+			if(staged.count == MODEL_CAPACITY)
+				continue;
+
+			result = lc_transaction_add(transaction, name, value);
+			_model_add(&staged, name, value);
+		}
+		else if(call == 1)
+		{
+			_read_value(input, value);
+			result = lc_transaction_set(transaction, name, value);
+
+			if(index == staged.count)
+				valid = 0;
+			else
+				strcpy(staged.variables[index].value, value);
+		}
+		else
+		{
+			result = lc_transaction_delete(transaction, name);
+
+			if(index == staged.count)
+				valid = 0;
+			else
+				_model_delete(&staged, index);
+		}
+
+		if(result == LC_ERROR)
+			abort();
+	}
+
+	if(rollback)
+	{
+		lc_rollback_transaction(transaction);
+		return;
+	}
+
+	int result = lc_commit_transaction(transaction);
+
+	if((result == LC_SUCCESS) != valid)
+		_fail("lc_commit_transaction");
+
+	if(result == LC_SUCCESS)
+		*model = staged;
+}
+
+static void _run_clone(struct fuzz_input *input, lc_config_t *configs)
+{
+	size_t target = fuzz_next_byte(input) % MODEL_CONFIGS;
+	size_t source = (target + 1) % MODEL_CONFIGS;
+
+	lc_clear_config(&configs[target]);
+
+	if(lc_clone_config(&configs[target], &configs[source]) == LC_ERROR)
+		_fail("lc_clone_config");
+
+	models[target] = models[source];
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	struct fuzz_input input = { data, size, 0 };
+	lc_config_t configs[MODEL_CONFIGS];
+
+	for(size_t i = 0; i < MODEL_CONFIGS; i++)
+	{
+		if(lc_init_config(&configs[i], NULL, FUZZ_DELIM) == LC_ERROR)
+			abort();
+
+		models[i].count = 0;
+	}
+
+	while(input.position < input.size)
+	{
+		uint8_t call = fuzz_next_byte(&input);
+		size_t index = (call >> 4) % MODEL_CONFIGS;
+		lc_config_t *config = &configs[index];
+		struct _model *model = &models[index];
+
+		switch(call % 6)
+		{
+		case 0:
+			_run_add(&input, config, model);
+			break;
+		case 1:
+			_run_set(&input, config, model);
+			break;
+		case 2:
+			_run_delete(&input, config, model);
+			break;
+		case 3:
+			_run_replace(&input, config, model);
+			break;
+		case 4:
+			_run_transaction(&input, config, model);
+			break;
+		case 5:
+			_run_clone(&input, configs);
+			break;
+		}
+
+		// the call may have changed a table shared with the other config
+		for(size_t i = 0; i < MODEL_CONFIGS; i++)
+			_check(&configs[i], &models[i]);
+	}
+
+	for(size_t i = 0; i < MODEL_CONFIGS; i++)
+		lc_clear_config(&configs[i]);
+
+	return 0;
+}
@@ -0,0 +1,34 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "fuzz.h"
+
+// load -> dump -> load must give the same variables and the same dump
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	lc_config_t config, reloaded;
+	size_t length = 0;
+
+	if(fuzz_load_reference(&config, data, size) == LC_ERROR)
+	{
+		lc_clear_config(&config);
+		return 0;
+	}
+
+	char *dump = fuzz_dump(&config, &length);
+
+	if(fuzz_load_reference(&reloaded, (const uint8_t *)dump, length) == LC_ERROR)
+		abort();
+
+	fuzz_expect_same(&config, LC_SUCCESS, &reloaded, LC_SUCCESS, "round-trip");
+
+	lc_diff_t *diff = lc_diff_configs(&config, &reloaded);
+	if(diff == NULL || lc_diff_get_size(diff) != 0)
+		abort();
+
+	lc_free_diff(diff);
+	free(dump);
+	lc_clear_config(&reloaded);
+	lc_clear_config(&config);
+	return 0;
+}
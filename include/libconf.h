@@ -5,6 +5,9 @@
 #define LC_SUCCESS 0
 #define LC_ERROR -1
 
+// changed on every incompatible change of the types and functions below
+#define LC_ABI_VERSION 5
+
 enum _lc_config_error
 {
 	LC_ERR_NONE = 0,
@@ -12,7 +15,10 @@ enum _lc_config_error
 	LC_ERR_FILE_NO = 2,
 	LC_ERR_MEMORY_NO = 3,
 	LC_ERR_WRITE_NO = 4,
-	LC_ERR_NOT_EXISTS = 5
+	LC_ERR_NOT_EXISTS = 5,
+	LC_ERR_SYNTAX = 6,
+	LC_ERR_DUPLICATE = 7,
+	LC_ERR_INVALID = 8
 };
 
 typedef enum lc_existence
@@ -22,26 +28,90 @@ typedef enum lc_existence
 	LC_EF_NOT_EXISTS = 2
 } lc_existence_t;
 
+typedef enum lc_duplicates
+{
+	LC_DUP_COLLECT = 0,
+	LC_DUP_FIRST = 1,
+	LC_DUP_LAST = 2,
+	LC_DUP_ERROR = 3
+} lc_duplicates_t;
+
+typedef enum lc_value_type
+{
+	LC_TYPE_STRING = 0,
+	LC_TYPE_INTEGER = 1,
+	LC_TYPE_FLOAT = 2,
+	LC_TYPE_BOOLEAN = 3,
+	LC_TYPE_SIZE = 4,
+	LC_TYPE_ENUM = 5
+} lc_value_type_t;
+
+typedef enum lc_codec
+{
+	LC_CODEC_NONE = 0,
+	LC_CODEC_GZIP = 1
+} lc_codec_t;
+
 typedef struct lc_config_variable
 {
 	char * name;
 	char * value;
 } lc_config_variable_t;
 
-struct _lc_config_list
+typedef struct lc_allocator
 {
-	lc_config_variable_t *variable;
-	struct _lc_config_list *next;
-};
+	void* (*alloc)(void *context, size_t size);
+	void* (*realloc)(void *context, void *pointer, size_t size);
+	void (*free)(void *context, void *pointer);
+	void *context;
+} lc_allocator_t;
+
+typedef int (*lc_variable_callback_t)(const char *name, const char *value, void *data);
+
+typedef struct lc_async lc_async_t;
+
+typedef struct lc_transaction lc_transaction_t;
+
+typedef struct lc_shm lc_shm_t;
+
+typedef struct lc_lazy lc_lazy_t;
+
+typedef enum lc_change
+{
+	LC_CHANGE_ADDED = 0,
+	LC_CHANGE_REMOVED = 1,
+	LC_CHANGE_CHANGED = 2
+} lc_change_t;
 
-typedef struct lc_config
+typedef struct lc_diff lc_diff_t;
+
+typedef struct lc_iterator lc_iterator_t;
+
+typedef struct lc_config lc_config_t;
+
+// with LC_OPAQUE defined the layout of lc_config_t is hidden, and configs are used only through
+// lc_create_config(), lc_destroy_config() and the functions below
+#ifndef LC_OPAQUE
+struct lc_config
 {
-	struct _lc_config_list *list;
-	size_t list_size;
+	struct _lc_config_table *table;
+	struct _lc_config_journal *journal;
+	struct _lc_config_overrides *overrides;
+	struct _lc_config_interpolation *interpolation;
+	struct _lc_config_profile *profile;
+	struct _lc_config_schema *schema;
+	struct _lc_memory *memory;
+	size_t size;
+	lc_duplicates_t duplicates;
 	enum _lc_config_error error_type;
+	size_t error_line;
+	size_t error_column;
 	char *filepath;
 	char *delim;
-} lc_config_t;
+};
+#endif
+
+typedef void (*lc_async_callback_t)(lc_config_t *config, int result, void *data);
 
 
 // basic config functions
@@ -49,10 +119,14 @@ int lc_init_config(lc_config_t *config, const char *filepath, const char *delim)
 
 void lc_clear_config(lc_config_t *config);
 
+int lc_clone_config(lc_config_t *clone, const lc_config_t *config);
+
 size_t lc_get_size(const lc_config_t *config);
 
 char* lc_get_error(const lc_config_t *config);
 
+int lc_get_error_position(const lc_config_t *config, size_t *line, size_t *column);
+
 char* lc_get_delim(lc_config_t *config);
 
 int lc_set_delim(lc_config_t *config, const char *delim);
@@ -63,6 +137,35 @@ int lc_set_path(lc_config_t *config, const char *filepath);
 
 void lc_clear_path(lc_config_t *config);
 
+int lc_set_default_allocator(const lc_allocator_t *allocator);
+
+int lc_set_allocator(lc_config_t *config, const lc_allocator_t *allocator);
+
+int lc_set_memory_limit(lc_config_t *config, size_t limit);
+
+size_t lc_get_memory_usage(const lc_config_t *config);
+
+int lc_set_duplicate_policy(lc_config_t *config, lc_duplicates_t policy);
+
+
+
+// handle functions for config
+unsigned int lc_get_abi_version(void);
+
+lc_config_t* lc_create_config(const char *filepath, const char *delim, unsigned int abi_version);
+
+void lc_destroy_config(lc_config_t *config);
+
+enum _lc_config_error lc_get_error_type(const lc_config_t *config);
+
+lc_duplicates_t lc_get_duplicate_policy(const lc_config_t *config);
+
+lc_iterator_t* lc_create_iterator(const lc_config_t *config, const char *prefix);
+
+int lc_iterator_next(lc_iterator_t *iterator, const char **name, const char **value);
+
+void lc_destroy_iterator(lc_iterator_t *iterator);
+
 
 
 // io functions for config
@@ -72,10 +175,127 @@ int lc_load_config_stream(lc_config_t *config, FILE *fp);
 
 int lc_dump_config(lc_config_t *config, const char *filepath);
 
+int lc_dump_config_compressed(lc_config_t *config, const char *filepath, lc_codec_t codec);
+
 int lc_dump_config_stream(lc_config_t *config, FILE *fp);
 
 void lc_print_config(const lc_config_t *config);
 
+int lc_foreach_variable(const lc_config_t *config, const char *prefix, lc_variable_callback_t callback, void *data);
+
+
+
+// async io functions for config
+lc_async_t* lc_load_config_async(lc_config_t *config, const char *filepath, lc_async_callback_t callback, void *data);
+
+lc_async_t* lc_dump_config_async(lc_config_t *config, const char *filepath, lc_async_callback_t callback, void *data);
+
+int lc_async_get_fd(const lc_async_t *request);
+
+int lc_async_wait(lc_async_t *request);
+
+
+
+// journal functions for config
+int lc_open_journal(lc_config_t *config, const char *journal_path);
+
+int lc_compact_journal(lc_config_t *config);
+
+void lc_close_journal(lc_config_t *config);
+
+
+
+// override functions for config
+int lc_set_env_overrides(lc_config_t *config, const char *prefix);
+
+int lc_set_arg_overrides(lc_config_t *config, int argc, char * const *argv);
+
+void lc_clear_overrides(lc_config_t *config);
+
+
+
+// interpolation functions for config
+int lc_set_interpolation(lc_config_t *config, int enable);
+
+
+
+// profiling functions for config
+int lc_set_profiling(lc_config_t *config, unsigned int sample_rate);
+
+void lc_reset_profile(lc_config_t *config);
+
+int lc_get_access_counts(const lc_config_t *config, const char *name, unsigned long long *reads, unsigned long long *writes, long long *accessed);
+
+int lc_dump_profile_stream(const lc_config_t *config, FILE *fp);
+
+int lc_reorder_by_hotness(lc_config_t *config);
+
+
+
+// validation functions for config
+int lc_add_rule(lc_config_t *config, const char *name, lc_value_type_t type);
+
+int lc_set_rule_range(lc_config_t *config, const char *name, double minimum, double maximum);
+
+int lc_set_rule_pattern(lc_config_t *config, const char *name, const char *pattern);
+
+int lc_set_rule_values(lc_config_t *config, const char *name, const char * const *values, size_t count);
+
+void lc_clear_rules(lc_config_t *config);
+
+int lc_get_integer(lc_config_t *config, const char *name, long long *value);
+
+int lc_get_float(lc_config_t *config, const char *name, double *value);
+
+
+
+// shared memory functions for config
+int lc_publish_config(lc_config_t *config, const char *name);
+
+int lc_unpublish_config(const char *name);
+
+lc_shm_t* lc_shm_attach(const char *name);
+
+void lc_shm_detach(lc_shm_t *shm);
+
+int lc_shm_refresh(lc_shm_t *shm);
+
+const char* lc_shm_get(const lc_shm_t *shm, const char *name);
+
+size_t lc_shm_get_size(const lc_shm_t *shm);
+
+unsigned long long lc_shm_get_generation(const lc_shm_t *shm);
+
+
+
+// lazy loading functions for config
+lc_lazy_t* lc_lazy_open(lc_config_t *config, const char *filepath);
+
+void lc_lazy_close(lc_lazy_t *lazy);
+
+const char* lc_lazy_get(lc_lazy_t *lazy, const char *name);
+
+size_t lc_lazy_get_size(const lc_lazy_t *lazy);
+
+size_t lc_lazy_get_decoded(const lc_lazy_t *lazy);
+
+
+
+// diff functions for config
+lc_diff_t* lc_diff_configs(const lc_config_t *from, const lc_config_t *to);
+
+void lc_free_diff(lc_diff_t *diff);
+
+size_t lc_diff_get_size(const lc_diff_t *diff);
+
+int lc_diff_get_change(const lc_diff_t *diff, size_t index, lc_change_t *change, const char **name, const char **value);
+
+int lc_dump_diff_stream(const lc_diff_t *diff, FILE *fp);
+
+lc_diff_t* lc_load_diff_stream(FILE *fp, const char *delim);
+
+int lc_apply_diff(lc_config_t *config, const lc_diff_t *diff);
+
 
 
 // functions for editing variables in config 
@@ -89,6 +309,10 @@ int lc_set_variable(lc_config_t *config, const char *name, const char *new_value
 
 lc_config_variable_t* lc_get_variable(lc_config_t *config, const char *name);
 
+size_t lc_get_variables(lc_config_t *config, const char * const *names, size_t count, const char **values);
+
+size_t lc_get_variable_array(lc_config_t *config, const char *name, const char **values, size_t count);
+
 int lc_replace_variable(lc_config_t *config, const char *name, lc_config_variable_t *variable);
 
 // int delete_variable() // variable, not char pointer
@@ -96,7 +320,24 @@ int lc_replace_variable(lc_config_t *config, const char *name, lc_config_variabl
 
 
 
-// functions for editing variables
+// functions for batch editing of variables in config
+lc_transaction_t* lc_begin_transaction(lc_config_t *config);
+
+int lc_transaction_add(lc_transaction_t *transaction, const char *name, const char *value);
+
+int lc_transaction_set(lc_transaction_t *transaction, const char *name, const char *new_value);
+
+int lc_transaction_delete(lc_transaction_t *transaction, const char *name);
+
+int lc_commit_transaction(lc_transaction_t *transaction);
+
+void lc_rollback_transaction(lc_transaction_t *transaction);
+
+
+
+// functions for editing variables. lc_destroy_variable(), lc_set_variable_name() and
+// lc_set_variable_value() take only variables returned by the library, a variable built by the
+// caller can be passed to the other functions, and is freed by the caller
 lc_config_variable_t* lc_create_variable(const char *name, const char *value);
 
 lc_config_variable_t* lc_create_variable_copy(lc_config_variable_t *variable);
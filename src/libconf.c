@@ -1,20 +1,408 @@
+#define _GNU_SOURCE
 #include <stdio.h>
+#include <stdio_ext.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 #include <stdarg.h>
 #include <errno.h>
+#include <stdint.h>
+#include <stddef.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/eventfd.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <limits.h>
+#include <time.h>
+#include <math.h>
+#include <regex.h>
+#if defined LC_HAVE_ZLIB
+#include <zlib.h>
+#endif
 #include "libconf.h"
 
-static const char * const error_msg[6] = {
+#define TABLE_SIZE 16
+#define TABLE_NPOS ((size_t)-1)
+#define TABLE_CHUNK 256
+#define INDEX_PAGE 1024
+#define MULTI_GET_BATCH 16
+#define JOURNAL_MARKER "# libconf journal generation "
+
+#if defined __GNUC__
+#define prefetch(address) __builtin_prefetch(address)
+#else
+#define prefetch(address) ((void)(address))
+#endif
+
+// accounting of all memory allocated for one config. the memory of a default allocator holds the
+// blocks that don't belong to a config, they may be freed from any thread, so it only counts them
+// in refs, with one more while it is the default
+struct _lc_memory
+{
+	lc_allocator_t allocator;
+	size_t used;
+	size_t limit;
+	int released;
+	int shared;
+	atomic_size_t refs;
+};
+
+// every internal allocation starts with this header, so it can be freed and counted without the config
+union _lc_memory_block
+{
+	struct
+	{
+		struct _lc_memory *memory;
+		size_t size;
+	} header;
+	max_align_t align;
+};
+
+// open addressing index over entries kept elsewhere, found by their hash.
+// buckets hold (index + 1) of the entries, 0 is an empty bucket. they are split into pages of
+// INDEX_PAGE buckets, which copies of an index share until one of them changes a page
+struct _lc_index_page
+{
+	size_t refs;
+	size_t buckets[];
+};
+
+struct _lc_hash_index
+{
+	struct _lc_index_page **pages;
+	size_t bucket_count;
+};
+
+// access counts of a table entry, accessed is the time of the last recorded access (0 if none)
+struct _lc_access
+{
+	uint64_t reads;
+	uint64_t writes;
+	time_t accessed;
+};
+
+// TABLE_CHUNK entries of a table: parallel arrays over their own string blob.
+// the name offset of a deleted entry is TABLE_NPOS
+struct _lc_table_chunk
+{
+	size_t refs;
+	uint32_t hashes[TABLE_CHUNK];
+	size_t name_offsets[TABLE_CHUNK];
+	size_t value_offsets[TABLE_CHUNK];
+	char *blob;
+	size_t blob_size;
+	size_t blob_capacity;
+	size_t blob_garbage;
+};
+
+struct _lc_access_chunk
+{
+	size_t refs;
+	struct _lc_access accesses[TABLE_CHUNK];
+};
+
+// packed storage kept in the order the entries were added, entry i is in chunks[i / TABLE_CHUNK].
+// dead counts the deleted entries until they are squeezed out. chunks, access counts and index pages
+// are shared by copies of the table, which copy one only before changing it. accesses and checked
+// are allocated on their first use, per chunk
+struct _lc_config_table
+{
+	size_t count;
+	size_t dead;
+	struct _lc_table_chunk **chunks;
+	struct _lc_access_chunk **accesses;
+	struct _lc_checked **checked;
+	size_t chunk_capacity;
+	struct _lc_hash_index index;
+	size_t refs;
+	struct _lc_memory *memory;
+};
+
+// one of every sample_rate reads and writes is recorded, with the weight sample_rate
+struct _lc_config_profile
+{
+	unsigned int sample_rate;
+	unsigned int countdown;
+};
+
+struct _lc_hotness
+{
+	uint64_t reads;
+	size_t index;
+};
+
+// parsed value of a table entry that passed its rule, valid is reset when the value is changed.
+// integer holds the value of integers and sizes, 0 or 1 for booleans, the index in the values of enums
+// and the length of strings
+struct _lc_checked
+{
+	int valid;
+	lc_value_type_t type;
+	union
+	{
+		long long integer;
+		double real;
+	} value;
+};
+
+// pattern is the source of regex, kept to copy the rule to clones
+struct _lc_rule
+{
+	char *name;
+	uint32_t hash;
+	lc_value_type_t type;
+	int has_range;
+	double minimum;
+	double maximum;
+	char *pattern;
+	regex_t regex;
+	char **values;
+	size_t value_count;
+};
+
+// rules are found through a hash index like the table entries
+struct _lc_config_schema
+{
+	struct _lc_rule **rules;
+	size_t count;
+	size_t capacity;
+	struct _lc_hash_index index;
+};
+
+// the journal starts with "@<generation>", the snapshot written by a compaction starts with
+// JOURNAL_MARKER "<generation>". records of a journal older than the snapshot are already in it
+// size is the end of the last record written whole, a failed write is cut back to it
+struct _lc_config_journal
+{
+	FILE *fp;
+	char *path;
+	uint64_t generation;
+	off_t size;
+};
+
+enum _lc_expansion_state
+{
+	LC_EXPANSION_NONE,
+	LC_EXPANSION_RUNNING,
+	LC_EXPANSION_DONE
+};
+
+// memoized expansion of a table entry, value is NULL if the entry has no references.
+// dependents are the entries whose expansion used this one
+struct _lc_expansion
+{
+	char *value;
+	size_t *dependents;
+	size_t dependent_count;
+	size_t dependent_capacity;
+	enum _lc_expansion_state state;
+};
+
+// entries are indexed like the table, expanded counts the entries in LC_EXPANSION_DONE state
+struct _lc_config_interpolation
+{
+	struct _lc_expansion *entries;
+	size_t capacity;
+	size_t expanded;
+};
+
+// argv is not copied, it must stay valid while the overrides are set
+struct _lc_config_overrides
+{
+	char *env_prefix;
+	char * const *argv;
+	int argc;
+};
+
+enum _lc_async_operation
+{
+	LC_ASYNC_LOAD,
+	LC_ASYNC_DUMP
+};
+
+enum _lc_transaction_operation
+{
+	LC_TXN_ADD,
+	LC_TXN_SET,
+	LC_TXN_DELETE
+};
+
+struct _lc_transaction_entry
+{
+	enum _lc_transaction_operation operation;
+	char *name;
+	char *value;
+};
+
+struct lc_transaction
+{
+	lc_config_t *config;
+	struct _lc_transaction_entry *entries;
+	size_t count;
+	size_t capacity;
+};
+
+struct lc_async
+{
+	pthread_t thread;
+	enum _lc_async_operation operation;
+	lc_config_t *config;
+	char *filepath;
+	lc_async_callback_t callback;
+	void *data;
+	int event_fd;
+	int result;
+};
+
+#define SHM_MAGIC 0x4853434cu // "LCSH"
+#define SHM_VERSION 1
+
+// control segment "<name>", holds the generation of the current data segment "<name>.<generation>"
+struct _lc_shm_control
+{
+	uint32_t magic;
+	uint32_t version;
+	_Atomic uint64_t generation;
+};
+
+// data segment: header, entries, buckets (index + 1, 0 is empty), strings.
+// only offsets from the segment start are stored, so it can be mapped at any address
+struct _lc_shm_header
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t generation;
+	uint64_t size;
+	uint64_t count;
+	uint64_t bucket_count;
+	uint64_t entries_offset;
+	uint64_t buckets_offset;
+};
+
+struct _lc_shm_entry
+{
+	uint64_t name_offset;
+	uint64_t value_offset;
+	uint32_t hash;
+	uint32_t reserved;
+};
+
+struct _lc_diff_entry
+{
+	lc_change_t change;
+	char *name;
+	char *value;
+};
+
+struct lc_diff
+{
+	struct _lc_diff_entry *entries;
+	size_t count;
+	size_t capacity;
+	char *delim;
+};
+
+struct lc_iterator
+{
+	const lc_config_t *config;
+	char *prefix;
+	size_t prefix_length;
+	size_t index;
+};
+
+struct lc_shm
+{
+	char *name;
+	const struct _lc_shm_control *control;
+	const struct _lc_shm_header *header;
+};
+
+// value of an entry loaded before, replaced by a later duplicate during load (last wins)
+struct _lc_load_undo
+{
+	size_t index;
+	size_t value_offset;
+};
+
+// blob_size and blob_garbage are those of the chunk of entry count, the one a load appends to
+struct _lc_load_state
+{
+	size_t count;
+	size_t blob_size;
+	size_t blob_garbage;
+	struct _lc_load_undo *undo;
+	size_t undo_count;
+	size_t undo_capacity;
+};
+
+struct _lc_line_buffer
+{
+	char *data;
+	size_t capacity;
+	size_t length;
+};
+
+// unfinished expansion of a table entry. reference is the entry it waits for, start and end
+// are where that "${name}" is in the value, reference is TABLE_NPOS if it waits for nothing
+struct _lc_expansion_frame
+{
+	size_t index;
+	size_t reference;
+	const char *cursor;
+	const char *start;
+	const char *end;
+	struct _lc_line_buffer buffer;
+};
+
+// references are expanded with an explicit stack, so long chains can't overflow the call stack
+struct _lc_expansion_stack
+{
+	struct _lc_expansion_frame *frames;
+	size_t count;
+	size_t capacity;
+};
+
+// key of a lazily loaded variable, offset is where the name starts in the mapped file
+struct _lc_lazy_entry
+{
+	uint64_t offset;
+	uint32_t hash;
+	uint32_t name_length;
+};
+
+// values[i] is NULL until the value of entries[i] is decoded, then it holds the name and the value
+// after it. fd stays open, so a file changed in place can be told before the map is read
+struct lc_lazy
+{
+	lc_config_t *config;
+	char *delim;
+	int fd;
+	const char *map;
+	size_t size;
+	struct _lc_lazy_entry *entries;
+	char **values;
+	size_t count;
+	size_t capacity;
+	struct _lc_hash_index index;
+	size_t decoded;
+	struct _lc_line_buffer line;
+	struct _lc_line_buffer heredoc;
+};
+
+static const char * const error_msg[9] = {
 	"LC_ERR_NONE",
 	"LC_ERR_EMPTY",
 	"LC_ERR_FILE_NO",
 	"LC_ERR_MEMORY_NO",
 	"LC_ERR_WRITE_NO",
-	"LC_ERR_NOT_EXISTS"
+	"LC_ERR_NOT_EXISTS",
+	"LC_ERR_SYNTAX",
+	"LC_ERR_DUPLICATE",
+	"LC_ERR_INVALID"
 };
 
 #if defined DEBUG
@@ -36,14 +424,106 @@ static FILE* _file_open(const char *filename, const char *mode)
 	assert(mode != NULL);
 
 	FILE *fp = fopen(filename, mode);
-	if(fp == NULL) {
+	if(fp == NULL)
+	{
 		warning(stderr, "[ERROR] %s: fopen() failed\n", __func__);
-		exit(EXIT_FAILURE);
 	}
 
 	return fp;
 }
 
+#if defined LC_HAVE_ZLIB
+static ssize_t _gzip_read(void *cookie, char *buffer, size_t size)
+{
+	int length = gzread(cookie, buffer, size > INT_MAX ? INT_MAX : (unsigned)size);
+
+	return length < 0 ? -1 : length;
+}
+
+static ssize_t _gzip_write(void *cookie, const char *buffer, size_t size)
+{
+	int length = gzwrite(cookie, buffer, size > INT_MAX ? INT_MAX : (unsigned)size);
+
+	return length == 0 && size != 0 ? -1 : length;
+}
+
+static int _gzip_close(void *cookie)
+{
+	return gzclose(cookie) == Z_OK ? 0 : -1;
+}
+
+// wraps gzip stream in FILE, so the usual read and write functions work on it
+static FILE* _gzip_open(gzFile gz, const char *mode)
+{
+	assert(mode != NULL);
+
+	if(gz == NULL)
+		return NULL;
+
+	cookie_io_functions_t functions = {
+		.read = _gzip_read,
+		.write = _gzip_write,
+		.seek = NULL,
+		.close = _gzip_close
+	};
+
+	FILE *fp = fopencookie(gz, mode, functions);
+	if(fp == NULL)
+		gzclose(gz);
+
+	return fp;
+}
+#endif
+
+// opens config file for reading, the codec is chosen by the magic bytes
+static FILE* _open_config_file(const char *filename, enum _lc_config_error *error)
+{
+	assert(filename != NULL);
+	assert(error != NULL);
+
+	unsigned char magic[4] = { 0 };
+
+	int fd = open(filename, O_RDONLY | O_CLOEXEC);
+	if(fd == -1)
+	{
+		*error = LC_ERR_FILE_NO;
+		return NULL;
+	}
+
+	ssize_t length = read(fd, magic, sizeof(magic));
+
+	if(length < 0 || lseek(fd, 0, SEEK_SET) == -1)
+	{
+		close(fd);
+		*error = LC_ERR_FILE_NO;
+		return NULL;
+	}
+
+	FILE *fp = NULL;
+
+	if(length >= 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+	{
+#if defined LC_HAVE_ZLIB
+		if((fp = _gzip_open(gzdopen(fd, "rb"), "r")) != NULL)
+			return fp;
+#else
+		warning(stderr, "[WARNING] %s: gzip support is not built in\n", __func__);
+#endif
+	}
+	else if(length == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd)
+	{
+		warning(stderr, "[WARNING] %s: zstd is not supported\n", __func__);
+	}
+	else if((fp = fdopen(fd, "r")) != NULL)
+	{
+		return fp;
+	}
+
+	close(fd);
+	*error = LC_ERR_FILE_NO;
+	return NULL;
+}
+
 static char* _duplicate_string(const char *string)
 {
 	assert(string != NULL);
@@ -53,7 +533,7 @@ static char* _duplicate_string(const char *string)
 	char *duplicate = calloc(length, sizeof(char));
 	if(duplicate == NULL) {
 		warning(stderr, "[ERROR] %s: allocation failed\n", __func__);
-		exit(EXIT_FAILURE);
+		return NULL;
 	}
 
 	memcpy(duplicate, string, length);
@@ -61,649 +541,6714 @@ static char* _duplicate_string(const char *string)
 	return duplicate;
 }
 
-static char* _find_delimiter(const char * string, const char * delim)
+// functions for memory
+
+static void* _default_alloc(void *context, size_t size)
 {
-	assert(string != NULL);
-	assert(delim != NULL);
+	(void)context;
+	return malloc(size);
+}
 
-	return strstr(string, delim);
+static void* _default_realloc(void *context, void *pointer, size_t size)
+{
+	(void)context;
+	return realloc(pointer, size);
 }
 
-static char* _read_line_from_file(FILE *fp)
+static void _default_free(void *context, void *pointer)
 {
-	assert(fp != NULL);
+	(void)context;
+	free(pointer);
+}
 
-	size_t line_length = LINE_SIZE;
+// never freed, so it holds one ref more
+static struct _lc_memory malloc_memory = { { _default_alloc, _default_realloc, _default_free, NULL }, 0, 0, 0, 1, 2 };
 
-	char *line_buffer = calloc(line_length, sizeof(char));
-	if(line_buffer == NULL)
-	{
-		warning(stderr, "[ERROR] %s: allocation failed\n", __func__);
-		exit(EXIT_FAILURE);
-	}
+// used for new configs and for allocations that don't belong to a config
+static struct _lc_memory *default_memory = &malloc_memory;
 
-	int c;
-	size_t position = 0;
+static struct _lc_memory* _memory_create(const lc_allocator_t *allocator, size_t limit)
+{
+	assert(allocator != NULL);
 
-	while(1)
-	{
-		c = fgetc(fp);
+	struct _lc_memory *memory = allocator->alloc(allocator->context, sizeof(struct _lc_memory));
+	if(memory == NULL)
+		return NULL;
 
-		if(c == EOF || c == '\n')
-		{
-			if(position == 0 && (c == EOF || c == '\n'))
-			{
-				free(line_buffer);
-				return NULL;
-			}
+	memory->allocator = *allocator;
+	memory->used = 0;
+	memory->limit = limit;
+	memory->released = 0;
+	memory->shared = 0;
+	atomic_init(&memory->refs, 1);
 
-			line_buffer[position] = '\0';
-			return line_buffer;
-		}
-		else
-		{
-			line_buffer[position] = c;
-		}
+	return memory;
+}
 
-		position++;
+static void _memory_destroy(struct _lc_memory *memory)
+{
+	assert(memory != NULL);
 
-		if(position >= line_length)
-		{
-			// TODO: make temporary pointer
-			line_length += LINE_SIZE;
-			line_buffer = realloc(line_buffer, line_length);
-			if(line_buffer == NULL)
-			{
-				warning(stderr, "[ERROR] %s: allocation failed\n", __func__);
-				exit(EXIT_FAILURE);
-			}
-		}
-	}
+	lc_allocator_t allocator = memory->allocator;
 
-	return NULL;
+	allocator.free(allocator.context, memory);
 }
 
-static int _write_line_to_file(FILE *fp, const char *line)
+static struct _lc_memory* _memory_of(const void *pointer)
 {
-	assert(fp != NULL);
-	assert(line != NULL);
-
-	if(fwrite(line, 1, strlen(line), fp) != strlen(line))
-		return LC_ERROR;
+	assert(pointer != NULL);
 
-	return LC_SUCCESS;
+	return ((const union _lc_memory_block *)pointer - 1)->header.memory;
 }
 
-// functions  for config list 
-
-static void _free_config_variable(lc_config_variable_t *variable)
+static void _memory_unref(struct _lc_memory *memory)
 {
-	if(variable == NULL)
-		return;
+	assert(memory != NULL);
 
-	free(variable->name);
-	free(variable->value);
-	free(variable);
+	if(atomic_fetch_sub(&memory->refs, 1) == 1)
+		_memory_destroy(memory);
 }
 
-static void _free_list_element(struct _lc_config_list *element)
+static void _memory_release(struct _lc_memory *memory)
 {
-	if(element == NULL)
+	if(memory == NULL)
 		return;
 
-	_free_config_variable(element->variable);
-	free(element);
+	// blocks shared with clones may outlive the config, the accounting is freed with the last of them
+	memory->released = 1;
+
+	if(memory->used == 0)
+		_memory_destroy(memory);
 }
 
-static lc_config_variable_t* _make_config_variable(const char *name, const char *value)
+// a block that doesn't belong to a config (memory is NULL) keeps the memory of the default
+// allocator, so it is freed by the allocator it came from
+static void* _memory_alloc(struct _lc_memory *memory, size_t size)
 {
-	lc_config_variable_t *new_variable = NULL;
+	size_t total = sizeof(union _lc_memory_block) + size;
 
-	new_variable = malloc(sizeof(lc_config_variable_t));
-	if(new_variable == NULL) {
-		warning(stderr, "[ERROR] %s: allocation failed\n", __func__);
-		exit(EXIT_FAILURE);
-	}
+	if(memory == NULL)
+		memory = default_memory;
 
-	new_variable->name = _duplicate_string(name);
-	if(new_variable->name == NULL)
+	if(memory->limit != 0 && memory->used + total > memory->limit)
 	{
-		free(new_variable);
+		warning(stderr, "[ERROR] %s: memory limit reached\n", __func__);
 		return NULL;
 	}
 
-	new_variable->value = _duplicate_string(value);
-	if(new_variable->value == NULL)
+	const lc_allocator_t *allocator = &memory->allocator;
+
+	union _lc_memory_block *block = allocator->alloc(allocator->context, total);
+	if(block == NULL)
 	{
-		free(new_variable->name);
-		free(new_variable);
+		warning(stderr, "[ERROR] %s: allocation failed\n", __func__);
 		return NULL;
 	}
 
-	return new_variable;
+	block->header.memory = memory;
+	block->header.size = total;
+
+	if(memory->shared)
+		atomic_fetch_add(&memory->refs, 1);
+	else
+		memory->used += total;
+
+	return block + 1;
 }
 
-static lc_config_variable_t* _create_variable_copy(lc_config_variable_t *variable)
+static void* _memory_zalloc(struct _lc_memory *memory, size_t size)
 {
-	assert(variable != NULL);
-
-	if(variable->name == NULL)
-		return NULL;
+	void *pointer = _memory_alloc(memory, size);
 
-	if(variable->value == NULL)
-		return NULL;
+	if(pointer != NULL)
+		memset(pointer, 0, size);
 
-	return _make_config_variable(variable->name, variable->value);
+	return pointer;
 }
 
-static struct _lc_config_list* _create_list_element(lc_config_variable_t *variable)
+static void _memory_free(void *pointer)
 {
-	assert(variable != NULL);
+	if(pointer == NULL)
+		return;
 
-	struct _lc_config_list *element = NULL;
+	union _lc_memory_block *block = (union _lc_memory_block *)pointer - 1;
+	struct _lc_memory *memory = block->header.memory;
+	size_t size = block->header.size;
 
-	element = malloc(sizeof(struct _lc_config_list));
-	if(element == NULL) {
-		warning(stderr, "[ERROR] %s: allocation failed\n", __func__);
-		exit(EXIT_FAILURE);
+	memory->allocator.free(memory->allocator.context, block);
+
+	if(memory->shared)
+	{
+		_memory_unref(memory);
+		return;
 	}
 
-	element->variable = variable;
-	element->next = NULL;
+	memory->used -= size;
 
-	return element;
+	if(memory->released && memory->used == 0)
+		_memory_destroy(memory);
 }
 
-static lc_config_variable_t* _convert_line_to_variable(const char *line, const char *delim)
+// on failure the old block stays valid
+static void* _memory_realloc(struct _lc_memory *memory, void *pointer, size_t size)
 {
-	assert(line != NULL);
-	assert(delim != NULL);
+	if(pointer == NULL)
+		return _memory_alloc(memory, size);
+
+	union _lc_memory_block *block = (union _lc_memory_block *)pointer - 1;
+	size_t total = sizeof(union _lc_memory_block) + size;
+	size_t old_total = block->header.size;
+
+	memory = block->header.memory;
+
+	if(memory->limit != 0 && total > old_total && memory->used + (total - old_total) > memory->limit)
+	{
+		warning(stderr, "[ERROR] %s: memory limit reached\n", __func__);
+		return NULL;
+	}
+
+	const lc_allocator_t *allocator = &memory->allocator;
 
-	char *dup_line = _duplicate_string(line);
-	if(dup_line == NULL)
+	block = allocator->realloc(allocator->context, block, total);
+	if(block == NULL)
+	{
+		warning(stderr, "[ERROR] %s: allocation failed\n", __func__);
 		return NULL;
+	}
+
+	block->header.size = total;
+
+	if(!memory->shared)
+		memory->used = memory->used - old_total + total;
+
+	return block + 1;
+}
+
+static char* _memory_duplicate_string(struct _lc_memory *memory, const char *string)
+{
+	assert(string != NULL);
+
+	size_t length = strlen(string) + 1;
+
+	char *duplicate = _memory_alloc(memory, length);
+	if(duplicate == NULL)
+		return NULL;
+
+	memcpy(duplicate, string, length);
+
+	return duplicate;
+}
+
+static char* _find_delimiter(const char * string, const char * delim)
+{
+	assert(string != NULL);
+	assert(delim != NULL);
+
+	return strstr(string, delim);
+}
+
+// grows the buffer geometrically, so long values are read in linear time
+static int _reserve_line_buffer(struct _lc_memory *memory, struct _lc_line_buffer *buffer, size_t size)
+{
+	assert(buffer != NULL);
+
+	if(size <= buffer->capacity)
+		return LC_SUCCESS;
+
+	size_t capacity = buffer->capacity == 0 ? LINE_SIZE : buffer->capacity;
+	while(capacity < size)
+		capacity *= 2;
+
+	char *data = _memory_realloc(memory, buffer->data, capacity);
+	if(data == NULL)
+		return LC_ERROR;
+
+	buffer->data = data;
+	buffer->capacity = capacity;
+	return LC_SUCCESS;
+}
+
+static int _append_line_buffer(struct _lc_memory *memory, struct _lc_line_buffer *buffer, const char *string, size_t length)
+{
+	assert(buffer != NULL);
+	assert(string != NULL);
+
+	if(_reserve_line_buffer(memory, buffer, buffer->length + length + 1) == LC_ERROR)
+		return LC_ERROR;
+
+	memcpy(buffer->data + buffer->length, string, length);
+	buffer->length += length;
+	buffer->data[buffer->length] = '\0';
+
+	return LC_SUCCESS;
+}
+
+// reads one line into the reused buffer without '\n', *line is NULL at the end of file
+static int _read_line_from_file(struct _lc_memory *memory, FILE *fp, struct _lc_line_buffer *buffer, char **line)
+{
+	assert(fp != NULL);
+	assert(buffer != NULL);
+	assert(line != NULL);
+
+	int c;
+	size_t position = 0;
+
+	*line = NULL;
+
+	while(1)
+	{
+		if(position + 1 >= buffer->capacity)
+		{
+			if(_reserve_line_buffer(memory, buffer, position + 2) == LC_ERROR)
+				return LC_ERROR;
+		}
+
+		c = getc_unlocked(fp);
+
+		if(c == EOF || c == '\n')
+			break;
+
+		buffer->data[position++] = c;
+	}
+
+	if(c == EOF && position == 0)
+		return LC_SUCCESS;
+
+	buffer->data[position] = '\0';
+	buffer->length = position;
+
+	*line = buffer->data;
+	return LC_SUCCESS;
+}
+
+static int _write_line_to_file(FILE *fp, const char *line)
+{
+	assert(fp != NULL);
+	assert(line != NULL);
+
+	if(fwrite(line, 1, strlen(line), fp) != strlen(line))
+		return LC_ERROR;
+
+	return LC_SUCCESS;
+}
+
+// functions for hash index
+
+// sets the hash of the entry at position, returns 0 for an entry that is left out of the index
+typedef int (*_lc_hash_getter_t)(const void *owner, size_t position, uint32_t *hash);
+
+static size_t _index_page_count(size_t bucket_count)
+{
+	return (bucket_count + INDEX_PAGE - 1) / INDEX_PAGE;
+}
+
+static size_t _index_page_size(size_t bucket_count)
+{
+	return sizeof(struct _lc_index_page) + (bucket_count < INDEX_PAGE ? bucket_count : INDEX_PAGE) * sizeof(size_t);
+}
+
+static size_t _index_bucket(const struct _lc_hash_index *index, size_t bucket)
+{
+	assert(index != NULL);
+	assert(bucket < index->bucket_count);
+
+	return index->pages[bucket / INDEX_PAGE]->buckets[bucket % INDEX_PAGE];
+}
+
+// the page of bucket must be owned by the index
+static void _index_set_bucket(struct _lc_hash_index *index, size_t bucket, size_t value)
+{
+	assert(index != NULL);
+	assert(bucket < index->bucket_count);
+	assert(index->pages[bucket / INDEX_PAGE]->refs == 1);
+
+	index->pages[bucket / INDEX_PAGE]->buckets[bucket % INDEX_PAGE] = value;
+}
+
+static void _index_release_page(struct _lc_index_page *page)
+{
+	if(page != NULL && --page->refs == 0)
+		_memory_free(page);
+}
+
+static void _index_free(struct _lc_hash_index *index)
+{
+	assert(index != NULL);
+
+	for(size_t i = 0; i < _index_page_count(index->bucket_count); i++)
+		_index_release_page(index->pages[i]);
+
+	_memory_free(index->pages);
+
+	index->pages = NULL;
+	index->bucket_count = 0;
+}
+
+// the copy shares every page with index
+static int _index_share(struct _lc_memory *memory, struct _lc_hash_index *copy, const struct _lc_hash_index *index)
+{
+	assert(copy != NULL);
+	assert(index != NULL);
+
+	size_t page_count = _index_page_count(index->bucket_count);
+
+	if(page_count == 0)
+		return LC_SUCCESS;
+
+	if((copy->pages = _memory_alloc(memory, page_count * sizeof(struct _lc_index_page*))) == NULL)
+		return LC_ERROR;
+
+	for(size_t i = 0; i < page_count; i++)
+	{
+		copy->pages[i] = index->pages[i];
+		copy->pages[i]->refs++;
+	}
+
+	copy->bucket_count = index->bucket_count;
+	return LC_SUCCESS;
+}
+
+// gives the index its own copy of the page of bucket, before the page is changed
+static int _index_own_page(struct _lc_memory *memory, struct _lc_hash_index *index, size_t bucket)
+{
+	assert(index != NULL);
+
+	struct _lc_index_page **page = &index->pages[bucket / INDEX_PAGE];
+
+	if((*page)->refs == 1)
+		return LC_SUCCESS;
+
+	size_t size = _index_page_size(index->bucket_count);
+
+	struct _lc_index_page *copy = _memory_alloc(memory, size);
+	if(copy == NULL)
+		return LC_ERROR;
+
+	memcpy(copy, *page, size);
+	copy->refs = 1;
+
+	(*page)->refs--;
+	*page = copy;
+
+	return LC_SUCCESS;
+}
+
+// owns the pages of the probe chain of hash through its first empties empty buckets. an insert of
+// the hash or the removal of an entry with it changes buckets up to the first one, every insert
+// made before them can fill one more
+static int _index_own_chain(struct _lc_memory *memory, struct _lc_hash_index *index, uint32_t hash, size_t empties)
+{
+	assert(index != NULL);
+	assert(index->bucket_count != 0);
+	assert(empties != 0);
+
+	size_t mask = index->bucket_count - 1;
+
+	for(size_t bucket = hash & mask; ; bucket = (bucket + 1) & mask)
+	{
+		if(_index_own_page(memory, index, bucket) == LC_ERROR)
+			return LC_ERROR;
+
+		if(_index_bucket(index, bucket) == 0 && --empties == 0)
+			return LC_SUCCESS;
+	}
+}
+
+// owns every page, for changes whose probe chains can't be told in advance
+static int _index_own(struct _lc_memory *memory, struct _lc_hash_index *index)
+{
+	assert(index != NULL);
+
+	for(size_t i = 0; i < _index_page_count(index->bucket_count); i++)
+	{
+		if(_index_own_page(memory, index, i * INDEX_PAGE) == LC_ERROR)
+			return LC_ERROR;
+	}
+
+	return LC_SUCCESS;
+}
+
+static void _index_insert(struct _lc_hash_index *index, uint32_t hash, size_t position)
+{
+	assert(index != NULL);
+	assert(index->bucket_count != 0);
+
+	size_t mask = index->bucket_count - 1;
+	size_t bucket = hash & mask;
+
+	while(_index_bucket(index, bucket) != 0)
+		bucket = (bucket + 1) & mask;
+
+	_index_set_bucket(index, bucket, position + 1);
+}
+
+// entries are inserted in position order, so the first of equal names is probed first.
+// every page must be owned by the index
+static void _index_rebuild(struct _lc_hash_index *index, size_t count, _lc_hash_getter_t hash_of, const void *owner)
+{
+	assert(index != NULL);
+
+	if(index->bucket_count == 0)
+		return;
+
+	for(size_t i = 0; i < _index_page_count(index->bucket_count); i++)
+	{
+		assert(index->pages[i]->refs == 1);
+
+		memset(index->pages[i]->buckets, 0, _index_page_size(index->bucket_count) - sizeof(struct _lc_index_page));
+	}
+
+	for(size_t i = 0; i < count; i++)
+	{
+		uint32_t hash = 0;
+
+		if(hash_of(owner, i, &hash))
+			_index_insert(index, hash, i);
+	}
+}
+
+// backward shift deletion: the entries after position in its probe chain are moved back into the hole,
+// unless that would put them before their home bucket, so no chain is cut and equal names keep their order
+static void _index_remove(struct _lc_hash_index *index, uint32_t hash, size_t position, _lc_hash_getter_t hash_of, const void *owner)
+{
+	assert(index != NULL);
+	assert(index->bucket_count != 0);
+
+	size_t mask = index->bucket_count - 1;
+	size_t hole = hash & mask;
+
+	while(_index_bucket(index, hole) != position + 1)
+		hole = (hole + 1) & mask;
+
+	for(size_t bucket = (hole + 1) & mask; _index_bucket(index, bucket) != 0; bucket = (bucket + 1) & mask)
+	{
+		uint32_t moved = 0;
+
+		hash_of(owner, _index_bucket(index, bucket) - 1, &moved);
+
+		// the home bucket is between the hole and the entry, it can't move back
+		if(((bucket - (moved & mask)) & mask) < ((bucket - hole) & mask))
+			continue;
+
+		_index_set_bucket(index, hole, _index_bucket(index, bucket));
+		hole = bucket;
+	}
+
+	_index_set_bucket(index, hole, 0);
+}
+
+// makes room for count entries, the used entries already in the index are inserted again if it grows
+static int _index_reserve(struct _lc_memory *memory, struct _lc_hash_index *index, size_t count, size_t used, _lc_hash_getter_t hash_of, const void *owner)
+{
+	assert(index != NULL);
+
+	// keep load factor at most 1/2
+	if(count * 2 <= index->bucket_count)
+		return LC_SUCCESS;
+
+	size_t bucket_count = index->bucket_count == 0 ? TABLE_SIZE * 2 : index->bucket_count;
+	while(bucket_count < count * 2)
+		bucket_count *= 2;
+
+	struct _lc_hash_index grown = { NULL, bucket_count };
+	size_t page_count = _index_page_count(bucket_count);
+
+	if((grown.pages = _memory_zalloc(memory, page_count * sizeof(struct _lc_index_page*))) == NULL)
+		return LC_ERROR;
+
+	for(size_t i = 0; i < page_count; i++)
+	{
+		if((grown.pages[i] = _memory_alloc(memory, _index_page_size(bucket_count))) == NULL)
+		{
+			_index_free(&grown);
+			return LC_ERROR;
+		}
+
+		grown.pages[i]->refs = 1;
+	}
+
+	_index_free(index);
+	*index = grown;
+
+	_index_rebuild(index, used, hash_of, owner);
+	return LC_SUCCESS;
+}
+
+// functions for packed table
+
+static uint32_t _hash_string(const char *string)
+{
+	assert(string != NULL);
+
+	// FNV-1a
+	uint32_t hash = 2166136261u;
+
+	while(*string != '\0')
+	{
+		hash ^= (unsigned char)*string++;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+static struct _lc_table_chunk* _chunk_create(struct _lc_memory *memory)
+{
+	struct _lc_table_chunk *chunk = _memory_alloc(memory, sizeof(struct _lc_table_chunk));
+	if(chunk == NULL)
+		return NULL;
+
+	chunk->refs = 1;
+	chunk->blob = NULL;
+	chunk->blob_size = 0;
+	chunk->blob_capacity = 0;
+	chunk->blob_garbage = 0;
+
+	return chunk;
+}
+
+static void _chunk_release(struct _lc_table_chunk *chunk)
+{
+	if(chunk == NULL || --chunk->refs != 0)
+		return;
+
+	_memory_free(chunk->blob);
+	_memory_free(chunk);
+}
+
+static void _access_chunk_release(struct _lc_access_chunk *chunk)
+{
+	if(chunk != NULL && --chunk->refs == 0)
+		_memory_free(chunk);
+}
+
+static int _chunk_reserve_blob(struct _lc_memory *memory, struct _lc_table_chunk *chunk, size_t length)
+{
+	assert(chunk != NULL);
+	assert(chunk->refs == 1);
+
+	if(chunk->blob_size + length <= chunk->blob_capacity)
+		return LC_SUCCESS;
+
+	size_t capacity = chunk->blob_capacity == 0 ? LINE_SIZE : chunk->blob_capacity;
+	while(capacity < chunk->blob_size + length)
+		capacity *= 2;
+
+	char *blob = _memory_realloc(memory, chunk->blob, capacity);
+	if(blob == NULL)
+		return LC_ERROR;
+
+	chunk->blob = blob;
+	chunk->blob_capacity = capacity;
+	return LC_SUCCESS;
+}
+
+// copies string to the end of blob, blob must be reserved before
+static size_t _chunk_store_string(struct _lc_table_chunk *chunk, const char *string, size_t length)
+{
+	assert(chunk != NULL);
+	assert(string != NULL);
+
+	size_t offset = chunk->blob_size;
+
+	memcpy(chunk->blob + offset, string, length + 1);
+	chunk->blob_size += length + 1;
+
+	return offset;
+}
+
+// used is the number of entries in the chunk, the capacity of blob stays so reserved room is kept
+static int _chunk_compact(struct _lc_memory *memory, struct _lc_table_chunk *chunk, size_t used)
+{
+	assert(chunk != NULL);
+	assert(chunk->refs == 1);
+
+	char *blob = _memory_alloc(memory, chunk->blob_capacity);
+	if(blob == NULL)
+		return LC_ERROR;
+
+	size_t size = 0;
+
+	for(size_t i = 0; i < used; i++)
+	{
+		if(chunk->name_offsets[i] == TABLE_NPOS)
+			continue;
+
+		const char *name = chunk->blob + chunk->name_offsets[i];
+		const char *value = chunk->blob + chunk->value_offsets[i];
+		size_t name_length = strlen(name) + 1;
+		size_t value_length = strlen(value) + 1;
+
+		memcpy(blob + size, name, name_length);
+		chunk->name_offsets[i] = size;
+		size += name_length;
+
+		memcpy(blob + size, value, value_length);
+		chunk->value_offsets[i] = size;
+		size += value_length;
+	}
+
+	_memory_free(chunk->blob);
+	chunk->blob = blob;
+	chunk->blob_size = size;
+	chunk->blob_garbage = 0;
+
+	return LC_SUCCESS;
+}
+
+static struct _lc_config_table* _table_create(struct _lc_memory *memory)
+{
+	struct _lc_config_table *table = _memory_zalloc(memory, sizeof(struct _lc_config_table));
+	if(table == NULL)
+		return NULL;
+
+	table->refs = 1;
+	table->memory = memory;
+	return table;
+}
+
+static void _table_free_chunks(struct _lc_table_chunk **chunks, struct _lc_access_chunk **accesses, struct _lc_checked **checked, size_t capacity)
+{
+	for(size_t i = 0; i < capacity; i++)
+	{
+		if(chunks != NULL)
+			_chunk_release(chunks[i]);
+
+		if(accesses != NULL)
+			_access_chunk_release(accesses[i]);
+
+		if(checked != NULL)
+			_memory_free(checked[i]);
+	}
+
+	_memory_free(chunks);
+	_memory_free(accesses);
+	_memory_free(checked);
+}
+
+static void _table_free(struct _lc_config_table *table)
+{
+	if(table == NULL)
+		return;
+
+	_table_free_chunks(table->chunks, table->accesses, table->checked, table->chunk_capacity);
+	_index_free(&table->index);
+	_memory_free(table);
+}
+
+// drops one reference, the last one frees the table
+static void _table_release(struct _lc_config_table *table)
+{
+	if(table != NULL && table->refs > 1)
+		table->refs--;
+	else
+		_table_free(table);
+}
+
+// makes room for count entries. their chunks are created here, so appending to them can't fail
+static int _table_reserve(struct _lc_config_table *table, size_t count)
+{
+	assert(table != NULL);
+
+	size_t chunk_count = (count + TABLE_CHUNK - 1) / TABLE_CHUNK;
+
+	if(chunk_count > table->chunk_capacity)
+	{
+		size_t capacity = table->chunk_capacity == 0 ? TABLE_SIZE : table->chunk_capacity;
+		while(capacity < chunk_count)
+			capacity *= 2;
+
+		size_t grown = capacity - table->chunk_capacity;
+
+		struct _lc_table_chunk **chunks = _memory_realloc(table->memory, table->chunks, capacity * sizeof(struct _lc_table_chunk*));
+		if(chunks == NULL)
+			return LC_ERROR;
+		memset(chunks + table->chunk_capacity, 0, grown * sizeof(struct _lc_table_chunk*));
+		table->chunks = chunks;
+
+		if(table->accesses != NULL)
+		{
+			struct _lc_access_chunk **accesses = _memory_realloc(table->memory, table->accesses, capacity * sizeof(struct _lc_access_chunk*));
+			if(accesses == NULL)
+				return LC_ERROR;
+			memset(accesses + table->chunk_capacity, 0, grown * sizeof(struct _lc_access_chunk*));
+			table->accesses = accesses;
+		}
+
+		if(table->checked != NULL)
+		{
+			struct _lc_checked **checked = _memory_realloc(table->memory, table->checked, capacity * sizeof(struct _lc_checked*));
+			if(checked == NULL)
+				return LC_ERROR;
+			memset(checked + table->chunk_capacity, 0, grown * sizeof(struct _lc_checked*));
+			table->checked = checked;
+		}
+
+		table->chunk_capacity = capacity;
+	}
+
+	for(size_t i = table->count / TABLE_CHUNK; i < chunk_count; i++)
+	{
+		if(table->chunks[i] == NULL && (table->chunks[i] = _chunk_create(table->memory)) == NULL)
+			return LC_ERROR;
+	}
+
+	return LC_SUCCESS;
+}
+
+static struct _lc_table_chunk* _table_chunk(const struct _lc_config_table *table, size_t index)
+{
+	assert(table != NULL);
+	assert(index / TABLE_CHUNK < table->chunk_capacity);
+
+	return table->chunks[index / TABLE_CHUNK];
+}
+
+// number of entries in the chunk of index
+static size_t _table_chunk_used(const struct _lc_config_table *table, size_t index)
+{
+	assert(table != NULL);
+
+	size_t first = index - index % TABLE_CHUNK;
+
+	return table->count - first < TABLE_CHUNK ? table->count - first : TABLE_CHUNK;
+}
+
+// gives the table its own copy of the chunk of index before the chunk is changed.
+// the strings of the copy keep their offsets
+static struct _lc_table_chunk* _table_own_chunk(struct _lc_config_table *table, size_t index)
+{
+	assert(table != NULL);
+
+	struct _lc_table_chunk **chunk = &table->chunks[index / TABLE_CHUNK];
+
+	if((*chunk)->refs == 1)
+		return *chunk;
+
+	struct _lc_table_chunk *copy = _memory_alloc(table->memory, sizeof(struct _lc_table_chunk));
+	if(copy == NULL)
+		return NULL;
+
+	memcpy(copy, *chunk, sizeof(struct _lc_table_chunk));
+	copy->refs = 1;
+	copy->blob = NULL;
+	copy->blob_capacity = 0;
+
+	if(_chunk_reserve_blob(table->memory, copy, (*chunk)->blob_size) == LC_ERROR)
+	{
+		_memory_free(copy);
+		return NULL;
+	}
+
+	if((*chunk)->blob_size != 0)
+		memcpy(copy->blob, (*chunk)->blob, (*chunk)->blob_size);
+
+	(*chunk)->refs--;
+	*chunk = copy;
+
+	return copy;
+}
+
+static int _table_is_live(const struct _lc_config_table *table, size_t index)
+{
+	assert(table != NULL);
+	assert(index < table->count);
+
+	return _table_chunk(table, index)->name_offsets[index % TABLE_CHUNK] != TABLE_NPOS;
+}
+
+static uint32_t _table_hash(const struct _lc_config_table *table, size_t index)
+{
+	assert(table != NULL);
+	assert(index < table->count);
+
+	return _table_chunk(table, index)->hashes[index % TABLE_CHUNK];
+}
+
+static const char* _table_name(const struct _lc_config_table *table, size_t index)
+{
+	assert(table != NULL);
+	assert(index < table->count);
+
+	const struct _lc_table_chunk *chunk = _table_chunk(table, index);
+
+	return chunk->blob + chunk->name_offsets[index % TABLE_CHUNK];
+}
+
+static const char* _table_value(const struct _lc_config_table *table, size_t index)
+{
+	assert(table != NULL);
+	assert(index < table->count);
+
+	const struct _lc_table_chunk *chunk = _table_chunk(table, index);
+
+	return chunk->blob + chunk->value_offsets[index % TABLE_CHUNK];
+}
+
+// access counts of the entry, NULL if none were recorded in its chunk
+static const struct _lc_access* _table_access(const struct _lc_config_table *table, size_t index)
+{
+	assert(table != NULL);
+
+	if(table->accesses == NULL || table->accesses[index / TABLE_CHUNK] == NULL)
+		return NULL;
+
+	return &table->accesses[index / TABLE_CHUNK]->accesses[index % TABLE_CHUNK];
+}
+
+// access counts are allocated on the first recorded access to a chunk, entries appended later start from zero.
+// counts shared with a copied table are copied first
+static struct _lc_access* _table_reserve_access(struct _lc_config_table *table, size_t index)
+{
+	assert(table != NULL);
+
+	if(table->accesses == NULL &&
+		(table->accesses = _memory_zalloc(table->memory, table->chunk_capacity * sizeof(struct _lc_access_chunk*))) == NULL)
+		return NULL;
+
+	struct _lc_access_chunk **chunk = &table->accesses[index / TABLE_CHUNK];
+
+	if(*chunk == NULL || (*chunk)->refs > 1)
+	{
+		struct _lc_access_chunk *copy = _memory_zalloc(table->memory, sizeof(struct _lc_access_chunk));
+		if(copy == NULL)
+			return NULL;
+
+		if(*chunk != NULL)
+		{
+			memcpy(copy->accesses, (*chunk)->accesses, sizeof(copy->accesses));
+			(*chunk)->refs--;
+		}
+
+		copy->refs = 1;
+		*chunk = copy;
+	}
+
+	return &(*chunk)->accesses[index % TABLE_CHUNK];
+}
+
+static void _table_reset_accesses(struct _lc_config_table *table)
+{
+	assert(table != NULL);
+
+	if(table->accesses == NULL)
+		return;
+
+	for(size_t i = 0; i < table->chunk_capacity; i++)
+		_access_chunk_release(table->accesses[i]);
+
+	_memory_free(table->accesses);
+	table->accesses = NULL;
+}
+
+// validated flag of the entry, NULL if none was set in its chunk
+static const struct _lc_checked* _table_checked(const struct _lc_config_table *table, size_t index)
+{
+	assert(table != NULL);
+
+	if(table->checked == NULL || table->checked[index / TABLE_CHUNK] == NULL)
+		return NULL;
+
+	return &table->checked[index / TABLE_CHUNK][index % TABLE_CHUNK];
+}
+
+// validated values are flagged on load or on the first typed read, entries start unchecked
+static struct _lc_checked* _table_reserve_checked(struct _lc_config_table *table, size_t index)
+{
+	assert(table != NULL);
+
+	if(table->checked == NULL &&
+		(table->checked = _memory_zalloc(table->memory, table->chunk_capacity * sizeof(struct _lc_checked*))) == NULL)
+		return NULL;
+
+	struct _lc_checked **checked = &table->checked[index / TABLE_CHUNK];
+
+	if(*checked == NULL && (*checked = _memory_zalloc(table->memory, TABLE_CHUNK * sizeof(struct _lc_checked))) == NULL)
+		return NULL;
+
+	return &(*checked)[index % TABLE_CHUNK];
+}
+
+static void _table_uncheck(struct _lc_config_table *table, size_t index)
+{
+	assert(table != NULL);
+
+	if(table->checked != NULL && table->checked[index / TABLE_CHUNK] != NULL)
+		table->checked[index / TABLE_CHUNK][index % TABLE_CHUNK].valid = 0;
+}
+
+static void _table_uncheck_all(struct _lc_config_table *table)
+{
+	assert(table != NULL);
+
+	if(table->checked == NULL)
+		return;
+
+	for(size_t i = 0; i < table->chunk_capacity; i++)
+		_memory_free(table->checked[i]);
+
+	_memory_free(table->checked);
+	table->checked = NULL;
+}
+
+static int _table_hash_of(const void *owner, size_t position, uint32_t *hash)
+{
+	const struct _lc_config_table *table = owner;
+
+	*hash = _table_hash(table, position);
+	return _table_is_live(table, position);
+}
+
+static void _table_reindex(struct _lc_config_table *table)
+{
+	assert(table != NULL);
+
+	_index_rebuild(&table->index, table->count, _table_hash_of, table);
+}
+
+static int _table_reserve_index(struct _lc_config_table *table, size_t count)
+{
+	assert(table != NULL);
+
+	return _index_reserve(table->memory, &table->index, count, table->count, _table_hash_of, table);
+}
+
+static int _table_append(struct _lc_config_table *table, const char *name, const char *value)
+{
+	assert(table != NULL);
+	assert(name != NULL);
+	assert(value != NULL);
+
+	size_t name_length = strlen(name);
+	size_t value_length = strlen(value);
+	size_t index = table->count;
+	uint32_t hash = _hash_string(name);
+
+	if(_table_reserve(table, index + 1) == LC_ERROR)
+		return LC_ERROR;
+
+	struct _lc_table_chunk *chunk = _table_own_chunk(table, index);
+
+	if(chunk == NULL || _chunk_reserve_blob(table->memory, chunk, name_length + value_length + 2) == LC_ERROR)
+		return LC_ERROR;
+
+	if(_table_reserve_index(table, index + 1) == LC_ERROR || _index_own_chain(table->memory, &table->index, hash, 1) == LC_ERROR)
+		return LC_ERROR;
+
+	chunk->hashes[index % TABLE_CHUNK] = hash;
+	chunk->name_offsets[index % TABLE_CHUNK] = _chunk_store_string(chunk, name, name_length);
+	chunk->value_offsets[index % TABLE_CHUNK] = _chunk_store_string(chunk, value, value_length);
+	table->count++;
+
+	_table_uncheck(table, index);
+
+	_index_insert(&table->index, hash, index);
+	return LC_SUCCESS;
+}
+
+static size_t _table_find_hashed(const struct _lc_config_table *table, const char *name, uint32_t hash)
+{
+	assert(name != NULL);
+
+	if(table == NULL || table->index.bucket_count == 0)
+		return TABLE_NPOS;
+
+	size_t mask = table->index.bucket_count - 1;
+
+	for(size_t bucket = hash & mask; _index_bucket(&table->index, bucket) != 0; bucket = (bucket + 1) & mask)
+	{
+		size_t index = _index_bucket(&table->index, bucket) - 1;
+
+		// dead entries are removed from the index, so every entry found is live
+		if(_table_hash(table, index) == hash && strcmp(_table_name(table, index), name) == 0)
+			return index;
+	}
+
+	return TABLE_NPOS;
+}
+
+static size_t _table_find(const struct _lc_config_table *table, const char *name)
+{
+	assert(name != NULL);
+
+	return _table_find_hashed(table, name, _hash_string(name));
+}
+
+// number of live entries with the name, more than one only with LC_DUP_COLLECT
+static size_t _table_count(const struct _lc_config_table *table, const char *name)
+{
+	assert(name != NULL);
+
+	if(table == NULL || table->index.bucket_count == 0)
+		return 0;
+
+	uint32_t hash = _hash_string(name);
+	size_t mask = table->index.bucket_count - 1;
+	size_t count = 0;
+
+	for(size_t bucket = hash & mask; _index_bucket(&table->index, bucket) != 0; bucket = (bucket + 1) & mask)
+	{
+		size_t index = _index_bucket(&table->index, bucket) - 1;
+
+		if(_table_hash(table, index) == hash && strcmp(_table_name(table, index), name) == 0)
+			count++;
+	}
+
+	return count;
+}
+
+// moves the entries into new chunks in the order given, or the live entries in table order if order
+// is NULL. everything is allocated before the table is changed, so a failure leaves it as it was.
+// validated flags are dropped, the next typed read sets them again
+static int _table_rebuild(struct _lc_config_table *table, const struct _lc_hotness *order, size_t count)
+{
+	assert(table != NULL);
+
+	struct _lc_memory *memory = table->memory;
+	size_t capacity = table->chunk_capacity;
+
+	if(order == NULL)
+		count = table->count - table->dead;
+
+	struct _lc_table_chunk **chunks = _memory_zalloc(memory, capacity * sizeof(struct _lc_table_chunk*));
+	struct _lc_access_chunk **accesses = NULL;
+
+	if(table->accesses != NULL)
+		accesses = _memory_zalloc(memory, capacity * sizeof(struct _lc_access_chunk*));
+
+	int result = chunks == NULL || (table->accesses != NULL && accesses == NULL) ? LC_ERROR : LC_SUCCESS;
+	size_t next = 0;
+
+	for(size_t i = 0; i < count && result == LC_SUCCESS; i++)
+	{
+		size_t index = 0;
+
+		if(order != NULL)
+		{
+			index = order[i].index;
+		}
+		else
+		{
+			while(!_table_is_live(table, next))
+				next++;
+
+			index = next++;
+		}
+
+		if(i % TABLE_CHUNK == 0)
+		{
+			if((chunks[i / TABLE_CHUNK] = _chunk_create(memory)) == NULL)
+			{
+				result = LC_ERROR;
+				break;
+			}
+
+			if(accesses != NULL)
+			{
+				if((accesses[i / TABLE_CHUNK] = _memory_zalloc(memory, sizeof(struct _lc_access_chunk))) == NULL)
+				{
+					result = LC_ERROR;
+					break;
+				}
+
+				accesses[i / TABLE_CHUNK]->refs = 1;
+			}
+		}
+
+		struct _lc_table_chunk *chunk = chunks[i / TABLE_CHUNK];
+		const char *name = _table_name(table, index);
+		const char *value = _table_value(table, index);
+		size_t name_length = strlen(name);
+		size_t value_length = strlen(value);
+
+		if(_chunk_reserve_blob(memory, chunk, name_length + value_length + 2) == LC_ERROR)
+		{
+			result = LC_ERROR;
+			break;
+		}
+
+		chunk->hashes[i % TABLE_CHUNK] = _table_hash(table, index);
+		chunk->name_offsets[i % TABLE_CHUNK] = _chunk_store_string(chunk, name, name_length);
+		chunk->value_offsets[i % TABLE_CHUNK] = _chunk_store_string(chunk, value, value_length);
+
+		const struct _lc_access *access = _table_access(table, index);
+
+		if(access != NULL)
+			accesses[i / TABLE_CHUNK]->accesses[i % TABLE_CHUNK] = *access;
+	}
+
+	// the index is rebuilt in place, its shared pages are copied last
+	if(result == LC_ERROR || _index_own(memory, &table->index) == LC_ERROR)
+	{
+		_table_free_chunks(chunks, accesses, NULL, chunks != NULL ? capacity : 0);
+		return LC_ERROR;
+	}
+
+	_table_free_chunks(table->chunks, table->accesses, table->checked, capacity);
+
+	table->chunks = chunks;
+	table->accesses = accesses;
+	table->checked = NULL;
+	table->count = count;
+	table->dead = 0;
+
+	_table_reindex(table);
+	return LC_SUCCESS;
+}
+
+// once most entries are dead they are squeezed out, which moves the live ones.
+// a failed allocation leaves them in place until the next delete
+static void _table_squeeze(struct _lc_config_table *table)
+{
+	assert(table != NULL);
+
+	if(table->dead > table->count / 2)
+		_table_rebuild(table, NULL, 0);
+}
+
+// the entry is left dead in place and only its bucket is removed, so a delete doesn't move the
+// other entries. the caller squeezes the dead entries out
+static int _table_remove(struct _lc_config_table *table, size_t index)
+{
+	assert(table != NULL);
+	assert(index < table->count);
+	assert(_table_is_live(table, index));
+
+	uint32_t hash = _table_hash(table, index);
+
+	struct _lc_table_chunk *chunk = _table_own_chunk(table, index);
+
+	if(chunk == NULL || _index_own_chain(table->memory, &table->index, hash, 1) == LC_ERROR)
+		return LC_ERROR;
+
+	_index_remove(&table->index, hash, index, _table_hash_of, table);
+
+	chunk->blob_garbage += strlen(_table_name(table, index)) + 1;
+	chunk->blob_garbage += strlen(_table_value(table, index)) + 1;
+	chunk->name_offsets[index % TABLE_CHUNK] = TABLE_NPOS;
+	table->dead++;
+
+	// a failed compaction leaves the garbage to the next change of the chunk
+	if(chunk->blob_garbage > chunk->blob_size / 2)
+		_chunk_compact(table->memory, chunk, _table_chunk_used(table, index));
+
+	return LC_SUCCESS;
+}
+
+// the chunk of the entry must be owned and have room for value
+static void _table_put_value(struct _lc_config_table *table, size_t index, const char *value, size_t value_length)
+{
+	assert(table != NULL);
+	assert(value != NULL);
+
+	struct _lc_table_chunk *chunk = _table_chunk(table, index);
+
+	assert(chunk->refs == 1);
+
+	chunk->blob_garbage += strlen(_table_value(table, index)) + 1;
+	chunk->value_offsets[index % TABLE_CHUNK] = _chunk_store_string(chunk, value, value_length);
+
+	_table_uncheck(table, index);
+}
+
+// name is NULL to keep the name of the entry. name and value must not point into the table
+static int _table_set_entry(struct _lc_config_table *table, size_t index, const char *name, const char *value)
+{
+	assert(table != NULL);
+	assert(index < table->count);
+	assert(value != NULL);
+
+	int same_name = name == NULL || strcmp(_table_name(table, index), name) == 0;
+	size_t name_length = same_name ? 0 : strlen(name);
+	size_t value_length = strlen(value);
+	size_t length = value_length + 1 + (same_name ? 0 : name_length + 1);
+	uint32_t old_hash = _table_hash(table, index);
+	uint32_t hash = same_name ? old_hash : _hash_string(name);
+
+	// the end of the probe chain is the right place only if no entry has the name yet,
+	// otherwise the order of equal names is restored by inserting all of them again
+	int reindex = !same_name && _table_find_hashed(table, name, hash) != TABLE_NPOS;
+
+	struct _lc_table_chunk *chunk = _table_own_chunk(table, index);
+	if(chunk == NULL)
+		return LC_ERROR;
+
+	// the pages the bucket moves through are owned before anything changes. a removal only moves
+	// entries back into its own chain, so the new bucket is in one of the two chains
+	if(!same_name)
+	{
+		if(reindex ? _index_own(table->memory, &table->index) == LC_ERROR :
+			(_index_own_chain(table->memory, &table->index, old_hash, 1) == LC_ERROR ||
+			_index_own_chain(table->memory, &table->index, hash, 1) == LC_ERROR))
+			return LC_ERROR;
+	}
+
+	if(chunk->blob_garbage > chunk->blob_size / 2)
+	{
+		if(_chunk_compact(table->memory, chunk, _table_chunk_used(table, index)) == LC_ERROR)
+			return LC_ERROR;
+	}
+
+	if(_chunk_reserve_blob(table->memory, chunk, length) == LC_ERROR)
+		return LC_ERROR;
+
+	_table_put_value(table, index, value, value_length);
+
+	if(!same_name)
+	{
+		if(!reindex)
+			_index_remove(&table->index, old_hash, index, _table_hash_of, table);
+
+		chunk->blob_garbage += strlen(_table_name(table, index)) + 1;
+		chunk->name_offsets[index % TABLE_CHUNK] = _chunk_store_string(chunk, name, name_length);
+		chunk->hashes[index % TABLE_CHUNK] = hash;
+
+		if(reindex)
+			_table_reindex(table);
+		else
+			_index_insert(&table->index, hash, index);
+	}
+
+	return LC_SUCCESS;
+}
+
+// drops the entries appended after the first count. blob_size and blob_garbage are those the chunk
+// of entry count had before. the dropped entries were the last ones inserted into the index,
+// so clearing their buckets from the last one gives back the index as it was
+static void _table_truncate(struct _lc_config_table *table, size_t count, size_t blob_size, size_t blob_garbage)
+{
+	assert(table != NULL);
+	assert(count <= table->count);
+
+	size_t mask = table->index.bucket_count - 1;
+
+	for(size_t i = table->count; i > count; i--)
+	{
+		size_t bucket = _table_hash(table, i - 1) & mask;
+
+		while(_index_bucket(&table->index, bucket) != i)
+			bucket = (bucket + 1) & mask;
+
+		_index_set_bucket(&table->index, bucket, 0);
+	}
+
+	for(size_t i = (count + TABLE_CHUNK - 1) / TABLE_CHUNK; i < table->chunk_capacity; i++)
+	{
+		_chunk_release(table->chunks[i]);
+		table->chunks[i] = NULL;
+
+		if(table->accesses != NULL)
+		{
+			_access_chunk_release(table->accesses[i]);
+			table->accesses[i] = NULL;
+		}
+	}
+
+	if(count % TABLE_CHUNK != 0 && count < table->count)
+	{
+		struct _lc_table_chunk *chunk = _table_chunk(table, count);
+
+		assert(chunk->refs == 1);
+
+		chunk->blob_size = blob_size;
+		chunk->blob_garbage = blob_garbage;
+	}
+
+	table->count = count;
+}
+
+// the copy shares the chunks, access counts and index pages of table, and copies each one only
+// before changing it. validated flags are not copied, the copy belongs to a config that may have other rules
+static struct _lc_config_table* _table_copy(struct _lc_memory *memory, const struct _lc_config_table *table)
+{
+	assert(table != NULL);
+
+	struct _lc_config_table *copy = _table_create(memory);
+	if(copy == NULL)
+		return NULL;
+
+	size_t capacity = table->chunk_capacity;
+	struct _lc_table_chunk **chunks = _memory_alloc(memory, capacity * sizeof(struct _lc_table_chunk*));
+	struct _lc_access_chunk **accesses = NULL;
+
+	if(table->accesses != NULL)
+		accesses = _memory_alloc(memory, capacity * sizeof(struct _lc_access_chunk*));
+
+	if(chunks == NULL || (table->accesses != NULL && accesses == NULL) || _index_share(memory, &copy->index, &table->index) == LC_ERROR)
+	{
+		_memory_free(chunks);
+		_memory_free(accesses);
+		_table_free(copy);
+		return NULL;
+	}
+
+	for(size_t i = 0; i < capacity; i++)
+	{
+		if((chunks[i] = table->chunks[i]) != NULL)
+			chunks[i]->refs++;
+
+		if(accesses != NULL && (accesses[i] = table->accesses[i]) != NULL)
+			accesses[i]->refs++;
+	}
+
+	copy->chunks = chunks;
+	copy->accesses = accesses;
+	copy->chunk_capacity = capacity;
+	copy->count = table->count;
+	copy->dead = table->dead;
+
+	return copy;
+}
+
+// functions for variables
+
+static void _free_config_variable(lc_config_variable_t *variable)
+{
+	if(variable == NULL)
+		return;
+
+	_memory_free(variable->name);
+	_memory_free(variable->value);
+	_memory_free(variable);
+}
+
+static lc_config_variable_t* _make_config_variable(struct _lc_memory *memory, const char *name, const char *value)
+{
+	assert(name != NULL);
+	assert(value != NULL);
+
+	lc_config_variable_t *new_variable = NULL;
+
+	new_variable = _memory_alloc(memory, sizeof(lc_config_variable_t));
+	if(new_variable == NULL)
+		return NULL;
+
+	new_variable->name = _memory_duplicate_string(memory, name);
+	if(new_variable->name == NULL)
+	{
+		_memory_free(new_variable);
+		return NULL;
+	}
+
+	new_variable->value = _memory_duplicate_string(memory, value);
+	if(new_variable->value == NULL)
+	{
+		_memory_free(new_variable->name);
+		_memory_free(new_variable);
+		return NULL;
+	}
+
+	return new_variable;
+}
+
+static lc_config_variable_t* _create_variable_copy(struct _lc_memory *memory, lc_config_variable_t *variable)
+{
+	assert(variable != NULL);
+
+	if(variable->name == NULL)
+		return NULL;
+
+	if(variable->value == NULL)
+		return NULL;
+
+	return _make_config_variable(memory, variable->name, variable->value);
+}
+
+static int _is_blank(char c)
+{
+	return c == ' ' || c == '\t';
+}
+
+static int _is_heredoc_terminator(const char *string)
+{
+	if(*string == '\0')
+		return 0;
+
+	for(; *string != '\0'; string++)
+	{
+		if(!(*string == '_' || (*string >= '0' && *string <= '9') ||
+			(*string >= 'a' && *string <= 'z') || (*string >= 'A' && *string <= 'Z')))
+			return 0;
+	}
+
+	return 1;
+}
+
+// splits the line in place into name and value, unquoting the value.
+// for a "<<TERMINATOR" value, *terminator is set and the value is read from the next lines.
+// returns 0 on success (*name is NULL for empty and comment lines), or the column of a syntax error
+static size_t _tokenize_line(char *line, size_t length, const char *delim, char **name, char **value, char **terminator)
+{
+	assert(line != NULL);
+	assert(delim != NULL);
+
+	*name = NULL;
+	*value = NULL;
+	*terminator = NULL;
+
+	if(length > 0 && line[length - 1] == '\r')
+		line[--length] = '\0';
+
+	char *start = line;
+	while(_is_blank(*start))
+		start++;
+
+	if(*start == '\0' || *start == '#' || *start == ';')
+		return 0;
+
+	char *separator = _find_delimiter(start, delim);
+	if(separator == NULL)
+		return length + 1;
+
+	char *name_end = separator;
+	while(name_end > start && _is_blank(name_end[-1]))
+		name_end--;
+
+	if(name_end == start)
+		return (size_t)(separator - line) + 1;
+
+	char *cursor = separator + strlen(delim);
+	while(_is_blank(*cursor))
+		cursor++;
+
+	*name_end = '\0';
+
+	if(*cursor != '"')
+	{
+		char *end = line + length;
+		while(end > cursor && _is_blank(end[-1]))
+			end--;
+
+		*end = '\0';
+
+		if(cursor[0] == '<' && cursor[1] == '<')
+		{
+			if(!_is_heredoc_terminator(cursor + 2))
+				return (size_t)(cursor - line) + 1;
+
+			*terminator = cursor + 2;
+		}
+
+		*name = start;
+		*value = cursor;
+		return 0;
+	}
+
+	// quoted value is unescaped in place, the result is never longer than the source
+	char *quote = cursor;
+	char *in = cursor + 1;
+	char *out = cursor;
+
+	while(*in != '"')
+	{
+		if(*in == '\0')
+			return (size_t)(quote - line) + 1;
+
+		if(*in == '\\')
+		{
+			switch(in[1])
+			{
+			case 'n': *out++ = '\n'; break;
+			case 'r': *out++ = '\r'; break;
+			case 't': *out++ = '\t'; break;
+			case '"': *out++ = '"'; break;
+			case '\\': *out++ = '\\'; break;
+			default:
+				return (size_t)(in - line) + 1;
+			}
+
+			in += 2;
+			continue;
+		}
+
+		*out++ = *in++;
+	}
+
+	*out = '\0';
+
+	for(in++; _is_blank(*in); in++)
+		;
+
+	if(*in != '\0' && *in != '#' && *in != ';')
+		return (size_t)(in - line) + 1;
+
+	*name = start;
+	*value = quote;
+	return 0;
+}
+
+// values that would not be read back as they are, are written in quotes
+static int _value_needs_quotes(const char *value)
+{
+	assert(value != NULL);
+
+	if(*value == '\0')
+		return 0;
+
+	size_t length = strlen(value);
+
+	if(_is_blank(value[0]) || value[0] == '"' || _is_blank(value[length - 1]))
+		return 1;
+
+	// would be read back as the start of a heredoc
+	if(value[0] == '<' && value[1] == '<')
+		return 1;
+
+	return strpbrk(value, "\r\n") != NULL;
+}
+
+// names are written as they are, so a name that would be skipped, trimmed or split at
+// the delimiter when the file is read again can't be dumped
+static int _name_is_writable(const char *name, const char *delim)
+{
+	assert(name != NULL);
+	assert(delim != NULL);
+
+	size_t length = strlen(name);
+	size_t delim_length = strlen(delim);
+
+	if(length == 0 || name[0] == '#' || name[0] == ';')
+		return 0;
+
+	if(_is_blank(name[0]) || _is_blank(name[length - 1]) || strpbrk(name, "\r\n") != NULL)
+		return 0;
+
+	// the delimiter must be found first right after the name, also when it starts inside the name
+	for(size_t i = 0; i < length; i++)
+	{
+		size_t j = 0;
+		while(j < delim_length && (i + j < length ? name[i + j] : delim[i + j - length]) == delim[j])
+			j++;
+
+		if(j == delim_length)
+			return 0;
+	}
+
+	return 1;
+}
+
+// checked before the file is opened, so a dump that would lose variables leaves the file as it was
+static int _check_names_to_dump(lc_config_t *config)
+{
+	assert(config != NULL);
+
+	const struct _lc_config_table *table = config->table;
+
+	if(table == NULL)
+		return LC_SUCCESS;
+
+	for(size_t i = 0; i < table->count; i++)
+	{
+		if(_table_is_live(table, i) && !_name_is_writable(_table_name(table, i), config->delim))
+		{
+			config->error_type = LC_ERR_INVALID;
+			return LC_ERROR;
+		}
+	}
+
+	return LC_SUCCESS;
+}
+
+// records are split on the first delimiter after the name, so like the dump functions the journal
+// refuses a name that would not be read back whole
+static int _check_journal_name(lc_config_t *config, const char *name)
+{
+	assert(config != NULL);
+	assert(name != NULL);
+
+	if(config->journal != NULL && !_name_is_writable(name, config->delim))
+	{
+		config->error_type = LC_ERR_INVALID;
+		return LC_ERROR;
+	}
+
+	return LC_SUCCESS;
+}
+
+static int _write_value_to_file(FILE *fp, const char *value)
+{
+	assert(fp != NULL);
+	assert(value != NULL);
+
+	if(!_value_needs_quotes(value))
+		return _write_line_to_file(fp, value);
+
+	if(fputc('"', fp) == EOF)
+		return LC_ERROR;
+
+	for(; *value != '\0'; value++)
+	{
+		const char *escape = NULL;
+
+		switch(*value)
+		{
+		case '\n': escape = "\\n"; break;
+		case '\r': escape = "\\r"; break;
+		case '\t': escape = "\\t"; break;
+		case '"': escape = "\\\""; break;
+		case '\\': escape = "\\\\"; break;
+		}
+
+		if(escape != NULL ? fputs(escape, fp) == EOF : fputc(*value, fp) == EOF)
+			return LC_ERROR;
+	}
+
+	if(fputc('"', fp) == EOF)
+		return LC_ERROR;
+
+	return LC_SUCCESS;
+}
+
+// gives config its own table before a change
+static int _detach_config(lc_config_t *config)
+{
+	assert(config != NULL);
+
+	struct _lc_config_table *table = config->table;
+
+	if(table == NULL || table->refs == 1)
+		return LC_SUCCESS;
+
+	struct _lc_config_table *copy = _table_copy(config->memory, table);
+	if(copy == NULL)
+	{
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	table->refs--;
+	config->table = copy;
+
+	return LC_SUCCESS;
+}
+
+// "--name=value", the last one before "--" wins
+static const char* _find_arg_override(const struct _lc_config_overrides *overrides, const char *name, size_t name_length)
+{
+	assert(overrides != NULL);
+
+	const char *value = NULL;
+
+	for(int i = 0; i < overrides->argc && overrides->argv[i] != NULL; i++)
+	{
+		const char *arg = overrides->argv[i];
+
+		if(arg[0] != '-' || arg[1] != '-')
+			continue;
+
+		if(arg[2] == '\0')
+			break;
+
+		if(strncmp(arg + 2, name, name_length) == 0 && arg[name_length + 2] == '=')
+			value = arg + name_length + 3;
+	}
+
+	return value;
+}
+
+// "section.key" is looked up as "<PREFIX>SECTION_KEY"
+static const char* _find_env_override(struct _lc_memory *memory, const struct _lc_config_overrides *overrides, const char *name, size_t name_length)
+{
+	assert(overrides != NULL);
+
+	char buffer[LINE_SIZE];
+	char *env_name = buffer;
+	size_t prefix_length = strlen(overrides->env_prefix);
+
+	if(prefix_length + name_length + 1 > sizeof(buffer))
+	{
+		if((env_name = _memory_alloc(memory, prefix_length + name_length + 1)) == NULL)
+			return NULL;
+	}
+
+	memcpy(env_name, overrides->env_prefix, prefix_length);
+
+	for(size_t i = 0; i < name_length; i++)
+	{
+		char c = name[i];
+
+		if(c >= 'a' && c <= 'z')
+			c = c - 'a' + 'A';
+		else if(!((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')))
+			c = '_';
+
+		env_name[prefix_length + i] = c;
+	}
+
+	env_name[prefix_length + name_length] = '\0';
+
+	const char *value = getenv(env_name);
+
+	if(env_name != buffer)
+		_memory_free(env_name);
+
+	return value;
+}
+
+// overrides are resolved on every lookup, so changes of argv or the environment are seen at once
+static const char* _find_override(const lc_config_t *config, const char *name)
+{
+	assert(config != NULL);
+	assert(name != NULL);
+
+	const struct _lc_config_overrides *overrides = config->overrides;
+	const char *value = NULL;
+
+	if(overrides == NULL)
+		return NULL;
+
+	size_t name_length = strlen(name);
+
+	if(overrides->argv != NULL && (value = _find_arg_override(overrides, name, name_length)) != NULL)
+		return value;
+
+	if(overrides->env_prefix != NULL)
+		value = _find_env_override(config->memory, overrides, name, name_length);
+
+	return value;
+}
+
+// value of the table entry with overrides applied
+static const char* _resolve_value(const lc_config_t *config, size_t index)
+{
+	assert(config != NULL);
+
+	const struct _lc_config_table *table = config->table;
+	const char *value = NULL;
+
+	if(config->overrides != NULL && (value = _find_override(config, _table_name(table, index))) != NULL)
+		return value;
+
+	return _table_value(table, index);
+}
+
+static void _clear_expansion(struct _lc_expansion *expansion)
+{
+	assert(expansion != NULL);
+
+	_memory_free(expansion->value);
+	_memory_free(expansion->dependents);
+	memset(expansion, 0, sizeof(struct _lc_expansion));
+}
+
+static void _clear_expansions(struct _lc_config_interpolation *interpolation)
+{
+	assert(interpolation != NULL);
+
+	for(size_t i = 0; i < interpolation->capacity; i++)
+		_clear_expansion(&interpolation->entries[i]);
+
+	interpolation->expanded = 0;
+}
+
+// drops all memoized values, used when table indexes change
+static void _reset_expansions(const lc_config_t *config)
+{
+	assert(config != NULL);
+
+	if(config->interpolation != NULL && config->interpolation->expanded != 0)
+		_clear_expansions(config->interpolation);
+}
+
+// drops the memoized value of the entry and of everything expanded from it.
+// the dependents are visited with a worklist, if it can't grow all memoized values are dropped
+static void _invalidate_expansion(const lc_config_t *config, size_t index)
+{
+	assert(config != NULL);
+
+	struct _lc_config_interpolation *interpolation = config->interpolation;
+
+	if(interpolation == NULL || index >= interpolation->capacity)
+		return;
+
+	if(interpolation->entries[index].state != LC_EXPANSION_DONE)
+		return;
+
+	size_t *pending = _memory_alloc(config->memory, sizeof(size_t));
+	size_t pending_count = 0;
+	size_t pending_capacity = 1;
+
+	if(pending == NULL)
+	{
+		_clear_expansions(interpolation);
+		return;
+	}
+
+	pending[pending_count++] = index;
+
+	while(pending_count > 0)
+	{
+		struct _lc_expansion *expansion = &interpolation->entries[pending[--pending_count]];
+
+		if(expansion->state != LC_EXPANSION_DONE)
+			continue;
+
+		size_t *dependents = expansion->dependents;
+		size_t dependent_count = expansion->dependent_count;
+
+		expansion->dependents = NULL;
+		_clear_expansion(expansion);
+		interpolation->expanded--;
+
+		if(pending_count + dependent_count > pending_capacity)
+		{
+			size_t capacity = pending_capacity;
+			while(capacity < pending_count + dependent_count)
+				capacity *= 2;
+
+			size_t *grown = _memory_realloc(config->memory, pending, capacity * sizeof(size_t));
+			if(grown == NULL)
+			{
+				_memory_free(dependents);
+				_memory_free(pending);
+				_clear_expansions(interpolation);
+				return;
+			}
+
+			pending = grown;
+			pending_capacity = capacity;
+		}
+
+		if(dependent_count != 0)
+			memcpy(pending + pending_count, dependents, dependent_count * sizeof(size_t));
+
+		pending_count += dependent_count;
+		_memory_free(dependents);
+	}
+
+	_memory_free(pending);
+}
+
+static int _reserve_expansions(struct _lc_memory *memory, struct _lc_config_interpolation *interpolation, size_t count)
+{
+	assert(interpolation != NULL);
+
+	if(count <= interpolation->capacity)
+		return LC_SUCCESS;
+
+	size_t capacity = interpolation->capacity == 0 ? TABLE_SIZE : interpolation->capacity;
+	while(capacity < count)
+		capacity *= 2;
+
+	struct _lc_expansion *entries = _memory_realloc(memory, interpolation->entries, capacity * sizeof(struct _lc_expansion));
+	if(entries == NULL)
+		return LC_ERROR;
+
+	memset(entries + interpolation->capacity, 0, (capacity - interpolation->capacity) * sizeof(struct _lc_expansion));
+
+	interpolation->entries = entries;
+	interpolation->capacity = capacity;
+	return LC_SUCCESS;
+}
+
+static int _add_dependent(struct _lc_memory *memory, struct _lc_expansion *expansion, size_t index)
+{
+	assert(expansion != NULL);
+
+	for(size_t i = 0; i < expansion->dependent_count; i++)
+	{
+		if(expansion->dependents[i] == index)
+			return LC_SUCCESS;
+	}
+
+	if(expansion->dependent_count == expansion->dependent_capacity)
+	{
+		size_t capacity = expansion->dependent_capacity == 0 ? 4 : expansion->dependent_capacity * 2;
+
+		size_t *dependents = _memory_realloc(memory, expansion->dependents, capacity * sizeof(size_t));
+		if(dependents == NULL)
+			return LC_ERROR;
+
+		expansion->dependents = dependents;
+		expansion->dependent_capacity = capacity;
+	}
+
+	expansion->dependents[expansion->dependent_count++] = index;
+	return LC_SUCCESS;
+}
+
+// sets *value if the entry is expanded already or has no references,
+// otherwise pushes a frame for it and leaves *value NULL
+static int _start_expansion(const lc_config_t *config, struct _lc_expansion_stack *stack, size_t index, const char **value)
+{
+	assert(config != NULL);
+	assert(stack != NULL);
+	assert(value != NULL);
+
+	struct _lc_config_interpolation *interpolation = config->interpolation;
+	struct _lc_expansion *expansion = &interpolation->entries[index];
+
+	*value = NULL;
+
+	if(expansion->state == LC_EXPANSION_DONE)
+	{
+		*value = expansion->value != NULL ? expansion->value : _resolve_value(config, index);
+		return LC_SUCCESS;
+	}
+
+	const char *raw = _resolve_value(config, index);
+
+	if(strstr(raw, "${") == NULL)
+	{
+		expansion->state = LC_EXPANSION_DONE;
+		interpolation->expanded++;
+		*value = raw;
+		return LC_SUCCESS;
+	}
+
+	if(stack->count == stack->capacity)
+	{
+		size_t capacity = stack->capacity == 0 ? 8 : stack->capacity * 2;
+
+		struct _lc_expansion_frame *frames = _memory_realloc(config->memory, stack->frames, capacity * sizeof(struct _lc_expansion_frame));
+		if(frames == NULL)
+			return LC_ERROR;
+
+		stack->frames = frames;
+		stack->capacity = capacity;
+	}
+
+	struct _lc_expansion_frame *frame = &stack->frames[stack->count];
+
+	memset(frame, 0, sizeof(struct _lc_expansion_frame));
+	frame->index = index;
+	frame->reference = TABLE_NPOS;
+	frame->cursor = raw;
+
+	if(_append_line_buffer(config->memory, &frame->buffer, "", 0) == LC_ERROR)
+		return LC_ERROR;
+
+	stack->count++;
+	expansion->state = LC_EXPANSION_RUNNING;
+	return LC_SUCCESS;
+}
+
+// puts the value of the reference the frame waited for (or the reference itself, if the
+// value is NULL) in place of "${name}"
+static int _finish_reference(const lc_config_t *config, struct _lc_expansion_frame *frame, const char *value)
+{
+	assert(config != NULL);
+	assert(frame != NULL);
+
+	struct _lc_config_interpolation *interpolation = config->interpolation;
+
+	// a cycle still makes a dependency, the entry must be expanded again if the other one changes
+	if(_add_dependent(config->memory, &interpolation->entries[frame->reference], frame->index) == LC_ERROR)
+		return LC_ERROR;
+
+	if(value != NULL && _append_line_buffer(config->memory, &frame->buffer, value, strlen(value)) == LC_ERROR)
+		return LC_ERROR;
+
+	if(value == NULL && _append_line_buffer(config->memory, &frame->buffer, frame->start, (size_t)(frame->end - frame->start) + 1) == LC_ERROR)
+		return LC_ERROR;
+
+	frame->cursor = frame->end + 1;
+	frame->reference = TABLE_NPOS;
+	return LC_SUCCESS;
+}
+
+// expands "${name}" references of the entry, "$${" is a literal "${".
+// references to unknown names and cycles are left as they are. returns NULL if memory runs out
+static const char* _expand_value(const lc_config_t *config, size_t index)
+{
+	assert(config != NULL);
+
+	struct _lc_config_interpolation *interpolation = config->interpolation;
+	const struct _lc_config_table *table = config->table;
+
+	if(_reserve_expansions(config->memory, interpolation, table->count) == LC_ERROR)
+		return NULL;
+
+	struct _lc_expansion_stack stack = { NULL, 0, 0 };
+	struct _lc_line_buffer name = { NULL, 0, 0 };
+	const char *value = NULL;
+
+	if(_start_expansion(config, &stack, index, &value) == LC_ERROR)
+		goto error;
+
+	while(stack.count > 0)
+	{
+		struct _lc_expansion_frame *frame = &stack.frames[stack.count - 1];
+
+		// the reference the frame waited for is expanded now
+		if(frame->reference != TABLE_NPOS && _finish_reference(config, frame, value) == LC_ERROR)
+			goto error;
+
+		while(1)
+		{
+			const char *cursor = frame->cursor;
+			const char *start = strstr(cursor, "${");
+			const char *end = start != NULL ? strchr(start + 2, '}') : NULL;
+
+			if(end == NULL)
+			{
+				if(_append_line_buffer(config->memory, &frame->buffer, cursor, strlen(cursor)) == LC_ERROR)
+					goto error;
+
+				struct _lc_expansion *expansion = &interpolation->entries[frame->index];
+				expansion->value = frame->buffer.data;
+				expansion->state = LC_EXPANSION_DONE;
+				interpolation->expanded++;
+
+				value = expansion->value;
+				stack.count--;
+				break;
+			}
+
+			if(start > cursor && start[-1] == '$')
+			{
+				if(_append_line_buffer(config->memory, &frame->buffer, cursor, (size_t)(start - cursor) - 1) == LC_ERROR ||
+					_append_line_buffer(config->memory, &frame->buffer, "${", 2) == LC_ERROR)
+					goto error;
+
+				frame->cursor = start + 2;
+				continue;
+			}
+
+			if(_append_line_buffer(config->memory, &frame->buffer, cursor, (size_t)(start - cursor)) == LC_ERROR)
+				goto error;
+
+			name.length = 0;
+			if(_append_line_buffer(config->memory, &name, start + 2, (size_t)(end - start) - 2) == LC_ERROR)
+				goto error;
+
+			size_t reference = _table_find(table, name.data);
+
+			if(reference == TABLE_NPOS)
+			{
+				if(_append_line_buffer(config->memory, &frame->buffer, start, (size_t)(end - start) + 1) == LC_ERROR)
+					goto error;
+
+				frame->cursor = end + 1;
+				continue;
+			}
+
+			frame->reference = reference;
+			frame->start = start;
+			frame->end = end;
+			value = NULL;
+
+			if(interpolation->entries[reference].state == LC_EXPANSION_RUNNING)
+			{
+				warning(stderr, "[WARNING] %s: reference cycle through \"%s\"\n", __func__, name.data);
+			}
+			else
+			{
+				size_t count = stack.count;
+
+				if(_start_expansion(config, &stack, reference, &value) == LC_ERROR)
+					goto error;
+
+				// the frame is finished when the pushed one is done
+				if(stack.count != count)
+					break;
+			}
+
+			if(_finish_reference(config, frame, value) == LC_ERROR)
+				goto error;
+		}
+	}
+
+	_memory_free(name.data);
+	_memory_free(stack.frames);
+
+	return value;
+
+error:
+	_memory_free(name.data);
+
+	for(size_t i = 0; i < stack.count; i++)
+		_memory_free(stack.frames[i].buffer.data);
+
+	_memory_free(stack.frames);
+
+	// dependencies of the unfinished expansions are lost, so nothing memoized can be trusted
+	_clear_expansions(interpolation);
+
+	return NULL;
+}
+
+// value of the table entry as the getters see it: overridden and expanded.
+// returns NULL if memory runs out
+static const char* _lookup_value(const lc_config_t *config, size_t index)
+{
+	assert(config != NULL);
+
+	if(config->interpolation != NULL)
+		return _expand_value(config, index);
+
+	return _resolve_value(config, index);
+}
+
+static void _record_access(lc_config_t *config, size_t index, int write)
+{
+	assert(config != NULL);
+
+	struct _lc_config_profile *profile = config->profile;
+
+	if(profile == NULL || --profile->countdown != 0)
+		return;
+
+	profile->countdown = profile->sample_rate;
+
+	// the counts belong to this config, a table shared with a clone is copied before they are
+	// written. a failed allocation only loses this sample
+	enum _lc_config_error error_type = config->error_type;
+
+	if(_detach_config(config) == LC_ERROR)
+	{
+		config->error_type = error_type;
+		return;
+	}
+
+	struct _lc_access *access = _table_reserve_access(config->table, index);
+	if(access == NULL)
+		return;
+
+	if(write)
+		access->writes += profile->sample_rate;
+	else
+		access->reads += profile->sample_rate;
+
+	access->accessed = time(NULL);
+}
+
+// hotter entries first, entries with equal reads keep their order
+static int _compare_hotness(const void *left, const void *right)
+{
+	const struct _lc_hotness *a = left;
+	const struct _lc_hotness *b = right;
+
+	if(a->reads != b->reads)
+		return a->reads > b->reads ? -1 : 1;
+
+	return a->index < b->index ? -1 : (a->index > b->index);
+}
+
+// live entries of the table ordered by reads, *count is set to their number. every entry is ranked
+// by the reads of the first of its name, so duplicate names keep their order
+static struct _lc_hotness* _rank_by_hotness(const struct _lc_config_table *table, size_t *count)
+{
+	assert(table != NULL);
+	assert(table->accesses != NULL);
+	assert(count != NULL);
+
+	struct _lc_hotness *order = _memory_alloc(table->memory, table->count * sizeof(struct _lc_hotness));
+	if(order == NULL)
+		return NULL;
+
+	size_t live = 0;
+
+	for(size_t i = 0; i < table->count; i++)
+	{
+		if(!_table_is_live(table, i))
+			continue;
+
+		size_t first = _table_find_hashed(table, _table_name(table, i), _table_hash(table, i));
+		const struct _lc_access *access = _table_access(table, first == TABLE_NPOS ? i : first);
+
+		order[live].reads = access != NULL ? access->reads : 0;
+		order[live].index = i;
+		live++;
+	}
+
+	qsort(order, live, sizeof(struct _lc_hotness), _compare_hotness);
+
+	*count = live;
+	return order;
+}
+
+// functions for validation
+
+static struct _lc_rule* _find_rule(const struct _lc_config_schema *schema, const char *name, uint32_t hash)
+{
+	assert(name != NULL);
+
+	if(schema == NULL || schema->index.bucket_count == 0)
+		return NULL;
+
+	size_t mask = schema->index.bucket_count - 1;
+
+	for(size_t bucket = hash & mask; _index_bucket(&schema->index, bucket) != 0; bucket = (bucket + 1) & mask)
+	{
+		struct _lc_rule *rule = schema->rules[_index_bucket(&schema->index, bucket) - 1];
+
+		if(rule->hash == hash && strcmp(rule->name, name) == 0)
+			return rule;
+	}
+
+	return NULL;
+}
+
+static void _clear_rule(struct _lc_rule *rule)
+{
+	assert(rule != NULL);
+
+	if(rule->pattern != NULL)
+		regfree(&rule->regex);
+
+	for(size_t i = 0; i < rule->value_count; i++)
+		_memory_free(rule->values[i]);
+
+	_memory_free(rule->pattern);
+	_memory_free(rule->values);
+
+	rule->has_range = 0;
+	rule->pattern = NULL;
+	rule->values = NULL;
+	rule->value_count = 0;
+}
+
+static void _free_schema(struct _lc_config_schema *schema)
+{
+	if(schema == NULL)
+		return;
+
+	for(size_t i = 0; i < schema->count; i++)
+	{
+		_clear_rule(schema->rules[i]);
+		_memory_free(schema->rules[i]->name);
+		_memory_free(schema->rules[i]);
+	}
+
+	_memory_free(schema->rules);
+	_index_free(&schema->index);
+	_memory_free(schema);
+}
+
+static int _rule_hash_of(const void *owner, size_t position, uint32_t *hash)
+{
+	*hash = ((const struct _lc_config_schema *)owner)->rules[position]->hash;
+	return 1;
+}
+
+static struct _lc_rule* _create_rule(struct _lc_memory *memory, struct _lc_config_schema *schema, const char *name, uint32_t hash)
+{
+	assert(schema != NULL);
+	assert(name != NULL);
+
+	if(schema->count == schema->capacity)
+	{
+		size_t capacity = schema->capacity == 0 ? TABLE_SIZE : schema->capacity * 2;
+
+		struct _lc_rule **rules = _memory_realloc(memory, schema->rules, capacity * sizeof(struct _lc_rule *));
+		if(rules == NULL)
+			return NULL;
+
+		schema->rules = rules;
+		schema->capacity = capacity;
+	}
+
+	if(_index_reserve(memory, &schema->index, schema->count + 1, schema->count, _rule_hash_of, schema) == LC_ERROR)
+		return NULL;
+
+	struct _lc_rule *rule = _memory_zalloc(memory, sizeof(struct _lc_rule));
+	if(rule == NULL)
+		return NULL;
+
+	if((rule->name = _memory_duplicate_string(memory, name)) == NULL)
+	{
+		_memory_free(rule);
+		return NULL;
+	}
+
+	rule->hash = hash;
+
+	schema->rules[schema->count] = rule;
+	_index_insert(&schema->index, hash, schema->count++);
+
+	return rule;
+}
+
+// the rule of name, with a NULL error type if the config has no such rule
+static struct _lc_rule* _get_rule(lc_config_t *config, const char *name)
+{
+	assert(config != NULL);
+	assert(name != NULL);
+
+	struct _lc_rule *rule = _find_rule(config->schema, name, _hash_string(name));
+
+	config->error_type = rule == NULL ? LC_ERR_NOT_EXISTS : LC_ERR_NONE;
+	return rule;
+}
+
+// flags were given by the old rules
+static void _uncheck_config(lc_config_t *config)
+{
+	assert(config != NULL);
+
+	struct _lc_config_table *table = config->table;
+
+	if(table != NULL)
+		_table_uncheck_all(table);
+}
+
+static int _parse_integer(const char *value, long long *result)
+{
+	assert(value != NULL);
+	assert(result != NULL);
+
+	const char *digits = value + (value[0] == '-' || value[0] == '+');
+	int base = digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X') ? 16 : 10;
+	char *end = NULL;
+
+	if(_is_blank(value[0]) || value[0] == '\0')
+		return LC_ERROR;
+
+	errno = 0;
+	*result = strtoll(value, &end, base);
+
+	if(errno != 0 || end == value || *end != '\0')
+		return LC_ERROR;
+
+	return LC_SUCCESS;
+}
+
+static int _parse_float(const char *value, double *result)
+{
+	assert(value != NULL);
+	assert(result != NULL);
+
+	char *end = NULL;
+
+	if(_is_blank(value[0]) || value[0] == '\0')
+		return LC_ERROR;
+
+	errno = 0;
+	*result = strtod(value, &end);
+
+	if(errno != 0 || end == value || *end != '\0' || !isfinite(*result))
+		return LC_ERROR;
+
+	return LC_SUCCESS;
+}
+
+static int _parse_boolean(const char *value, long long *result)
+{
+	assert(value != NULL);
+	assert(result != NULL);
+
+	static const char * const names[] = { "false", "true", "no", "yes", "off", "on", "0", "1" };
+
+	for(size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+	{
+		if(strcasecmp(value, names[i]) == 0)
+		{
+			*result = (long long)(i % 2);
+			return LC_SUCCESS;
+		}
+	}
+
+	return LC_ERROR;
+}
+
+// decimal number of bytes with an optional binary suffix: k, m, g, t (any case), and an optional b
+static int _parse_size(const char *value, long long *result)
+{
+	assert(value != NULL);
+	assert(result != NULL);
+
+	char *end = NULL;
+	unsigned int shift = 0;
+
+	if(value[0] < '0' || value[0] > '9')
+		return LC_ERROR;
+
+	errno = 0;
+	unsigned long long size = strtoull(value, &end, 10);
+
+	if(errno != 0)
+		return LC_ERROR;
+
+	switch(*end)
+	{
+	case 'k': case 'K': shift = 10; end++; break;
+	case 'm': case 'M': shift = 20; end++; break;
+	case 'g': case 'G': shift = 30; end++; break;
+	case 't': case 'T': shift = 40; end++; break;
+	}
+
+	if(*end == 'b' || *end == 'B')
+		end++;
+
+	if(*end != '\0' || size > ((unsigned long long)LLONG_MAX >> shift))
+		return LC_ERROR;
+
+	*result = (long long)(size << shift);
+	return LC_SUCCESS;
+}
+
+// checks value against rule (may be NULL, then only the type is checked) and parses it into checked
+static int _check_value(const struct _lc_rule *rule, lc_value_type_t type, const char *value, struct _lc_checked *checked)
+{
+	assert(value != NULL);
+	assert(checked != NULL);
+
+	size_t choice = 0;
+
+	if(rule != NULL && rule->values != NULL)
+	{
+		while(choice < rule->value_count && strcmp(rule->values[choice], value) != 0)
+			choice++;
+
+		if(choice == rule->value_count)
+			return LC_ERROR;
+	}
+
+	if(rule != NULL && rule->pattern != NULL && regexec(&rule->regex, value, 0, NULL, 0) != 0)
+		return LC_ERROR;
+
+	int result = LC_SUCCESS;
+	double number = 0;
+
+	switch(type)
+	{
+	case LC_TYPE_STRING:
+		checked->value.integer = (long long)strlen(value);
+		number = (double)checked->value.integer;
+		break;
+
+	case LC_TYPE_INTEGER:
+		result = _parse_integer(value, &checked->value.integer);
+		number = (double)checked->value.integer;
+		break;
+
+	case LC_TYPE_FLOAT:
+		result = _parse_float(value, &checked->value.real);
+		number = checked->value.real;
+		break;
+
+	case LC_TYPE_BOOLEAN:
+		result = _parse_boolean(value, &checked->value.integer);
+		break;
+
+	case LC_TYPE_SIZE:
+		result = _parse_size(value, &checked->value.integer);
+		number = (double)checked->value.integer;
+		break;
+
+	case LC_TYPE_ENUM:
+		// an enum without values has no valid value
+		if(rule == NULL || rule->values == NULL)
+			return LC_ERROR;
+
+		checked->value.integer = (long long)choice;
+		break;
+	}
+
+	if(result == LC_ERROR)
+		return LC_ERROR;
+
+	if(rule != NULL && rule->has_range && type != LC_TYPE_BOOLEAN && type != LC_TYPE_ENUM &&
+		(number < rule->minimum || number > rule->maximum))
+		return LC_ERROR;
+
+	checked->valid = 1;
+	checked->type = type;
+	return LC_SUCCESS;
+}
+
+// values with references are checked when they are read, after the expansion
+static int _is_checked_on_load(const lc_config_t *config, const char *value)
+{
+	assert(config != NULL);
+	assert(value != NULL);
+
+	return config->interpolation == NULL || strstr(value, "${") == NULL;
+}
+
+static void _print_table(const lc_config_t *config)
+{
+	assert(config != NULL);
+
+	const struct _lc_config_table *table = config->table;
+
+	for(size_t i = 0; i < table->count; i++)
+	{
+		if(!_table_is_live(table, i))
+			continue;
+
+		const char *value = _lookup_value(config, i);
+
+		printf("%s=%s\n", _table_name(table, i), value != NULL ? value : _table_value(table, i));
+	}
+
+	printf("\n");
+}
+
+static int _add_table_entry(lc_config_t *config, const char *name, const char *value)
+{
+	assert(config != NULL);
+	assert(name != NULL);
+	assert(value != NULL);
+
+	if(_detach_config(config) == LC_ERROR)
+		return LC_ERROR;
+
+	if(config->table == NULL)
+	{
+		config->table = _table_create(config->memory);
+		if(config->table == NULL)
+		{
+			config->error_type = LC_ERR_MEMORY_NO;
+			return LC_ERROR;
+		}
+	}
+
+	if(_table_append(config->table, name, value) == LC_ERROR)
+	{
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	// the new name may be referenced by memoized values
+	_reset_expansions(config);
+
+	config->error_type = LC_ERR_NONE;
+	config->size++;
+	return LC_SUCCESS;
+}
+
+static size_t _find_table_index(lc_config_t *config, const char *name)
+{
+	assert(config != NULL);
+	assert(name != NULL);
+
+	size_t index = _table_find(config->table, name);
+
+	config->error_type = index == TABLE_NPOS ? LC_ERR_NOT_EXISTS : LC_ERR_NONE;
+	return index;
+}
+
+// the parsed value of name, from the flag set on load or by an earlier read if there is one.
+// types is the mask (1 << type) of types the caller can use, type is used for names without a rule
+static int _get_checked_value(lc_config_t *config, const char *name, lc_value_type_t type, unsigned int types, struct _lc_checked *checked)
+{
+	assert(config != NULL);
+	assert(name != NULL);
+	assert(checked != NULL);
+
+	if(config->size == 0)
+	{
+		config->error_type = LC_ERR_EMPTY;
+		return LC_ERROR;
+	}
+
+	size_t index = _find_table_index(config, name);
+	if(index == TABLE_NPOS)
+		return LC_ERROR;
+
+	_record_access(config, index, 0);
+
+	struct _lc_config_table *table = config->table;
+
+	// flags are kept only for the own values of an unshared table
+	int cached = table->refs == 1 && config->overrides == NULL && config->interpolation == NULL;
+
+	const struct _lc_checked *flag = cached ? _table_checked(table, index) : NULL;
+
+	if(flag != NULL && flag->valid && (types & (1u << flag->type)) != 0)
+	{
+		*checked = *flag;
+		return LC_SUCCESS;
+	}
+
+	const struct _lc_rule *rule = _find_rule(config->schema, name, _table_hash(table, index));
+	const char *value = _lookup_value(config, index);
+
+	if(value == NULL)
+	{
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	config->error_line = 0;
+	config->error_column = 0;
+
+	if(_check_value(rule, rule != NULL ? rule->type : type, value, checked) == LC_ERROR ||
+		(types & (1u << checked->type)) == 0)
+	{
+		config->error_type = LC_ERR_INVALID;
+		return LC_ERROR;
+	}
+
+	// a failed allocation only loses the flag
+	struct _lc_checked *reserved = cached ? _table_reserve_checked(table, index) : NULL;
+
+	if(reserved != NULL)
+		*reserved = *checked;
+
+	return LC_SUCCESS;
+}
+
+static int _delete_table_entry(lc_config_t *config, size_t index)
+{
+	assert(config != NULL);
+
+	if(_detach_config(config) == LC_ERROR)
+		return LC_ERROR;
+
+	if(_table_remove(config->table, index) == LC_ERROR)
+	{
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	_table_squeeze(config->table);
+	_reset_expansions(config);
+
+	config->error_type = LC_ERR_NONE;
+	config->size--;
+	return LC_SUCCESS;
+}
+
+static int _rewrite_table_entry_value(lc_config_t *config, size_t index, const char *new_value)
+{
+	assert(config != NULL);
+	assert(new_value != NULL);
+
+	if(_detach_config(config) == LC_ERROR)
+		return LC_ERROR;
+
+	if(_table_set_entry(config->table, index, NULL, new_value) == LC_ERROR)
+	{
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	_invalidate_expansion(config, index);
+	_record_access(config, index, 1);
+
+	config->error_type = LC_ERR_NONE;
+	return LC_SUCCESS;
+}
+
+static int _replace_table_entry(lc_config_t *config, size_t index, const char *name, const char *value)
+{
+	assert(config != NULL);
+	assert(name != NULL);
+	assert(value != NULL);
+
+	if(_detach_config(config) == LC_ERROR)
+		return LC_ERROR;
+
+	if(strcmp(_table_name(config->table, index), name) == 0)
+		_invalidate_expansion(config, index);
+	else
+		_reset_expansions(config);
+
+	if(_table_set_entry(config->table, index, name, value) == LC_ERROR)
+	{
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	_record_access(config, index, 1);
+
+	config->error_type = LC_ERR_NONE;
+	return LC_SUCCESS;
+}
+
+// functions for transactions
+
+static void _free_transaction(lc_transaction_t *transaction)
+{
+	assert(transaction != NULL);
+
+	for(size_t i = 0; i < transaction->count; i++)
+	{
+		struct _lc_transaction_entry *entry = &transaction->entries[i];
+
+		_memory_free(entry->name);
+		_memory_free(entry->value);
+	}
+
+	_memory_free(transaction->entries);
+	_memory_free(transaction);
+}
+
+static int _stage_transaction_entry(lc_transaction_t *transaction, enum _lc_transaction_operation operation, const char *name, const char *value)
+{
+	assert(transaction != NULL);
+	assert(name != NULL);
+
+	if(transaction->count >= transaction->capacity)
+	{
+		size_t capacity = transaction->capacity == 0 ? TABLE_SIZE : transaction->capacity * 2;
+
+		struct _lc_transaction_entry *entries = _memory_realloc(transaction->config->memory, transaction->entries, capacity * sizeof(struct _lc_transaction_entry));
+		if(entries == NULL)
+			return LC_ERROR;
+
+		transaction->entries = entries;
+		transaction->capacity = capacity;
+	}
+
+	struct _lc_transaction_entry *entry = &transaction->entries[transaction->count];
+
+	memset(entry, 0, sizeof(struct _lc_transaction_entry));
+	entry->operation = operation;
+
+	if((entry->name = _memory_duplicate_string(transaction->config->memory, name)) == NULL)
+		return LC_ERROR;
+
+	if(value != NULL && (entry->value = _memory_duplicate_string(transaction->config->memory, value)) == NULL)
+	{
+		_memory_free(entry->name);
+		return LC_ERROR;
+	}
+
+	transaction->count++;
+	return LC_SUCCESS;
+}
+
+// replays the staged number of entries of every name, so set/delete of a missing variable fails before
+// anything is applied. a delete removes one entry, like lc_delete_variable(), so with duplicates the
+// name can still be set after it
+static int _validate_transaction(lc_config_t *config, const lc_transaction_t *transaction)
+{
+	assert(config != NULL);
+	assert(transaction != NULL);
+
+	// names are inserted while they are probed, so the index starts empty
+	struct _lc_hash_index index = { NULL, 0 };
+	size_t *live = _memory_alloc(config->memory, transaction->count * sizeof(size_t));
+
+	if(live == NULL || _index_reserve(config->memory, &index, transaction->count, 0, NULL, NULL) == LC_ERROR)
+	{
+		_index_free(&index);
+		_memory_free(live);
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	size_t mask = index.bucket_count - 1;
+	int result = LC_SUCCESS;
+
+	for(size_t i = 0; i < transaction->count && result == LC_SUCCESS; i++)
+	{
+		const struct _lc_transaction_entry *entry = &transaction->entries[i];
+		size_t bucket = _hash_string(entry->name) & mask;
+
+		if(entry->operation != LC_TXN_DELETE && _check_journal_name(config, entry->name) == LC_ERROR)
+		{
+			result = LC_ERROR;
+			break;
+		}
+
+		while(_index_bucket(&index, bucket) != 0 && strcmp(transaction->entries[_index_bucket(&index, bucket) - 1].name, entry->name) != 0)
+			bucket = (bucket + 1) & mask;
+
+		size_t count = _index_bucket(&index, bucket) != 0 ? live[_index_bucket(&index, bucket) - 1] : _table_count(config->table, entry->name);
+
+		if(entry->operation != LC_TXN_ADD && count == 0)
+		{
+			config->error_type = LC_ERR_NOT_EXISTS;
+			result = LC_ERROR;
+		}
+
+		live[i] = entry->operation == LC_TXN_ADD ? count + 1 : entry->operation == LC_TXN_DELETE ? count - 1 : count;
+		_index_set_bucket(&index, bucket, i + 1);
+	}
+
+	_index_free(&index);
+	_memory_free(live);
+	return result;
+}
+
+// reserves table space and allocates everything the commit needs, so applying can't fail.
+// a set or delete changes the chunk of one of the entries with its name, or of an entry added
+// before it, so all of those chunks are owned and get room for the value
+static int _prepare_transaction(lc_config_t *config, lc_transaction_t *transaction)
+{
+	assert(config != NULL);
+	assert(transaction != NULL);
+
+	size_t adds = 0;
+	size_t deletes = 0;
+
+	for(size_t i = 0; i < transaction->count; i++)
+	{
+		if(transaction->entries[i].operation == LC_TXN_ADD)
+			adds++;
+		else if(transaction->entries[i].operation == LC_TXN_DELETE)
+			deletes++;
+	}
+
+	if(_detach_config(config) == LC_ERROR)
+		return LC_ERROR;
+
+	if(config->table == NULL && (config->table = _table_create(config->memory)) == NULL)
+		return LC_ERROR;
+
+	struct _lc_config_table *table = config->table;
+	size_t first = table->count;
+
+	if(_table_reserve(table, first + adds) == LC_ERROR || _table_reserve_index(table, first + adds) == LC_ERROR)
+		return LC_ERROR;
+
+	// the probe chains of the adds and deletes are owned through one more empty bucket than there are
+	// adds. a large transaction reaches most pages that way, so all of them are owned at once
+	int own_all = (adds + 1) * (adds + deletes) > table->index.bucket_count / 2;
+
+	if(adds + deletes != 0 && own_all && _index_own(config->memory, &table->index) == LC_ERROR)
+		return LC_ERROR;
+
+	size_t chunk_count = (first + adds + TABLE_CHUNK - 1) / TABLE_CHUNK;
+
+	size_t *lengths = _memory_zalloc(config->memory, chunk_count * sizeof(size_t));
+	if(lengths == NULL)
+		return LC_ERROR;
+
+	size_t position = first;
+	int result = LC_SUCCESS;
+
+	for(size_t i = 0; i < transaction->count && result == LC_SUCCESS; i++)
+	{
+		struct _lc_transaction_entry *entry = &transaction->entries[i];
+		uint32_t hash = _hash_string(entry->name);
+
+		if(entry->operation != LC_TXN_SET && !own_all && _index_own_chain(config->memory, &table->index, hash, adds + 1) == LC_ERROR)
+		{
+			result = LC_ERROR;
+			break;
+		}
+
+		if(entry->operation == LC_TXN_ADD)
+		{
+			if(_table_own_chunk(table, position) == NULL)
+				result = LC_ERROR;
+
+			lengths[position++ / TABLE_CHUNK] += strlen(entry->name) + strlen(entry->value) + 2;
+			continue;
+		}
+
+		size_t length = entry->operation == LC_TXN_SET ? strlen(entry->value) + 1 : 0;
+		size_t mask = table->index.bucket_count - 1;
+
+		for(size_t chunk = first / TABLE_CHUNK; adds != 0 && chunk < chunk_count; chunk++)
+			lengths[chunk] += length;
+
+		for(size_t bucket = hash & mask; table->index.bucket_count != 0 && _index_bucket(&table->index, bucket) != 0; bucket = (bucket + 1) & mask)
+		{
+			size_t index = _index_bucket(&table->index, bucket) - 1;
+
+			if(_table_hash(table, index) != hash || strcmp(_table_name(table, index), entry->name) != 0)
+				continue;
+
+			if(_table_own_chunk(table, index) == NULL)
+			{
+				result = LC_ERROR;
+				break;
+			}
+
+			lengths[index / TABLE_CHUNK] += length;
+		}
+	}
+
+	for(size_t chunk = 0; chunk < chunk_count && result == LC_SUCCESS; chunk++)
+	{
+		if(lengths[chunk] != 0)
+			result = _chunk_reserve_blob(config->memory, table->chunks[chunk], lengths[chunk]);
+	}
+
+	_memory_free(lengths);
+	return result;
+}
+
+static void _apply_transaction(lc_config_t *config, lc_transaction_t *transaction)
+{
+	assert(config != NULL);
+	assert(transaction != NULL);
+
+	struct _lc_config_table *table = config->table;
+	size_t index = 0;
+
+	_reset_expansions(config);
+
+	for(size_t i = 0; i < transaction->count; i++)
+	{
+		struct _lc_transaction_entry *entry = &transaction->entries[i];
+
+		switch(entry->operation)
+		{
+		case LC_TXN_ADD:
+			_table_append(table, entry->name, entry->value);
+			config->size++;
+			break;
+
+		case LC_TXN_SET:
+			index = _table_find(table, entry->name);
+
+			_table_put_value(table, index, entry->value, strlen(entry->value));
+			_record_access(config, index, 1);
+			break;
+
+		case LC_TXN_DELETE:
+			_table_remove(table, _table_find(table, entry->name));
+			config->size--;
+			break;
+		}
+	}
+
+	// the entries stay in their reserved chunks until the last change is applied
+	_table_squeeze(table);
+
+	config->error_type = LC_ERR_NONE;
+}
+
+// io functions
+
+// drops the entries added after the first count, used to undo a failed load
+static void _truncate_config(lc_config_t *config, const struct _lc_load_state *state)
+{
+	assert(config != NULL);
+	assert(state != NULL);
+
+	struct _lc_config_table *table = config->table;
+
+	if(table == NULL || table->count == state->count)
+		return;
+
+	_reset_expansions(config);
+
+	// entries are appended to the end of the last blob, so its old size cuts them off.
+	// a load adds no dead entries, so all entries after count are live
+	config->size -= table->count - state->count;
+
+	_table_truncate(table, state->count, state->blob_size, state->blob_garbage);
+}
+
+// reads heredoc lines up to the terminator line into heredoc as "name\0terminator\0value".
+// *closed is 0 if the end of file came first
+static int _read_heredoc(struct _lc_memory *memory, FILE *fp, struct _lc_line_buffer *buffer, struct _lc_line_buffer *heredoc,
+	const char *name, const char *terminator, size_t *line_number, int *closed)
+{
+	assert(buffer != NULL);
+	assert(heredoc != NULL);
+	assert(line_number != NULL);
+	assert(closed != NULL);
+
+	char *line = NULL;
+	size_t name_length = strlen(name);
+	size_t terminator_length = strlen(terminator);
+	size_t value_offset = name_length + terminator_length + 2;
+
+	heredoc->length = 0;
+	*closed = 0;
+
+	if(_append_line_buffer(memory, heredoc, name, name_length + 1) == LC_ERROR ||
+		_append_line_buffer(memory, heredoc, terminator, terminator_length + 1) == LC_ERROR)
+		return LC_ERROR;
+
+	while(1)
+	{
+		if(_read_line_from_file(memory, fp, buffer, &line) == LC_ERROR)
+			return LC_ERROR;
+
+		if(line == NULL)
+			return LC_SUCCESS;
+
+		(*line_number)++;
+
+		size_t length = buffer->length;
+		if(length > 0 && line[length - 1] == '\r')
+			line[--length] = '\0';
+
+		char *start = line;
+		char *end = line + length;
+
+		while(_is_blank(*start))
+			start++;
+		while(end > start && _is_blank(end[-1]))
+			end--;
+
+		if((size_t)(end - start) == terminator_length && memcmp(start, heredoc->data + name_length + 1, terminator_length) == 0)
+		{
+			*closed = 1;
+			return LC_SUCCESS;
+		}
+
+		if(heredoc->length > value_offset && _append_line_buffer(memory, heredoc, "\n", 1) == LC_ERROR)
+			return LC_ERROR;
+
+		if(_append_line_buffer(memory, heredoc, line, length) == LC_ERROR)
+			return LC_ERROR;
+	}
+}
+
+// last wins: the value of the earlier entry is replaced in place, so indexes and order stay.
+// every replacement of an entry from before the load gets an undo record with the old value
+static int _load_replace_value(lc_config_t *config, struct _lc_load_state *state, size_t index, const char *value)
+{
+	assert(config != NULL);
+	assert(state != NULL);
+	assert(value != NULL);
+
+	if(_detach_config(config) == LC_ERROR)
+		return LC_ERROR;
+
+	struct _lc_config_table *table = config->table;
+	size_t value_length = strlen(value);
+
+	struct _lc_table_chunk *chunk = _table_own_chunk(table, index);
+
+	if(chunk == NULL || _chunk_reserve_blob(config->memory, chunk, value_length + 1) == LC_ERROR)
+		return LC_ERROR;
+
+	if(index < state->count)
+	{
+		if(state->undo_count == state->undo_capacity)
+		{
+			size_t capacity = state->undo_capacity == 0 ? TABLE_SIZE : state->undo_capacity * 2;
+
+			struct _lc_load_undo *undo = _memory_realloc(config->memory, state->undo, capacity * sizeof(struct _lc_load_undo));
+			if(undo == NULL)
+				return LC_ERROR;
+
+			state->undo = undo;
+			state->undo_capacity = capacity;
+		}
+
+		state->undo[state->undo_count].index = index;
+		state->undo[state->undo_count].value_offset = chunk->value_offsets[index % TABLE_CHUNK];
+		state->undo_count++;
+	}
+
+	_table_put_value(table, index, value, value_length);
+
+	_reset_expansions(config);
+	return LC_SUCCESS;
+}
+
+// keeps or restores the values replaced during load, then frees the undo records
+static void _finish_load(lc_config_t *config, struct _lc_load_state *state, int result)
+{
+	assert(config != NULL);
+	assert(state != NULL);
+
+	struct _lc_config_table *table = config->table;
+
+	for(size_t i = state->undo_count; i > 0 && result == LC_ERROR; i--)
+	{
+		struct _lc_load_undo *undo = &state->undo[i - 1];
+		struct _lc_table_chunk *chunk = _table_chunk(table, undo->index);
+
+		// the value written by the load is the garbage now, instead of the old one
+		chunk->blob_garbage += strlen(_table_value(table, undo->index)) + 1;
+		chunk->blob_garbage -= strlen(chunk->blob + undo->value_offset) + 1;
+		chunk->value_offsets[undo->index % TABLE_CHUNK] = undo->value_offset;
+
+		_table_uncheck(table, undo->index);
+	}
+
+	if(result == LC_ERROR)
+		_truncate_config(config, state);
+
+	_memory_free(state->undo);
+}
+
+static int _read_file_to_config(lc_config_t *config, FILE *fp)
+{
+	assert(config != NULL);
+	assert(fp != NULL);
+
+	struct _lc_line_buffer buffer = { NULL, 0, 0 };
+	struct _lc_line_buffer heredoc = { NULL, 0, 0 };
+	char *line = NULL;
+	char *name = NULL;
+	char *value = NULL;
+	char *terminator = NULL;
+	size_t line_number = 0;
+	size_t column = 0;
+	int closed = 0;
+	int result = LC_ERROR;
+	size_t name_line = 0;
+	size_t name_column = 0;
+	size_t value_column = 0;
+	size_t index = TABLE_NPOS;
+	const struct _lc_rule *rule = NULL;
+	struct _lc_checked checked = { 0, LC_TYPE_STRING, { 0 } };
+
+	struct _lc_load_state state = { 0, 0, 0, NULL, 0, 0 };
+
+	if(config->table != NULL)
+		state.count = config->table->count;
+
+	// the chunk of entry count is the one appended to
+	if(state.count % TABLE_CHUNK != 0)
+	{
+		const struct _lc_table_chunk *chunk = _table_chunk(config->table, state.count);
+
+		state.blob_size = chunk->blob_size;
+		state.blob_garbage = chunk->blob_garbage;
+	}
+
+	config->error_line = 0;
+	config->error_column = 0;
+	config->error_type = LC_ERR_MEMORY_NO;
+
+	flockfile(fp);
+
+	while(1)
+	{
+		if(_read_line_from_file(config->memory, fp, &buffer, &line) == LC_ERROR)
+			break;
+
+		if(line == NULL)
+		{
+			config->error_type = LC_ERR_NONE;
+			result = LC_SUCCESS;
+			break;
+		}
+
+		line_number++;
+
+		if((column = _tokenize_line(line, buffer.length, config->delim, &name, &value, &terminator)) != 0)
+		{
+			warning(stderr, "[WARNING] %s: syntax error at %zu:%zu\n", __func__, line_number, column);
+			config->error_type = LC_ERR_SYNTAX;
+			config->error_line = line_number;
+			config->error_column = column;
+			break;
+		}
+
+		// empty line or comment
+		if(name == NULL)
+			continue;
+
+		name_line = line_number;
+		name_column = (size_t)(name - line) + 1;
+		value_column = (size_t)(value - line) + 1;
+
+		if(terminator != NULL)
+		{
+			size_t heredoc_line = line_number;
+			size_t heredoc_column = value_column;
+
+			if(_read_heredoc(config->memory, fp, &buffer, &heredoc, name, terminator, &line_number, &closed) == LC_ERROR)
+				break;
+
+			// an unterminated heredoc is reported where it starts
+			if(!closed)
+			{
+				warning(stderr, "[WARNING] %s: unterminated heredoc at %zu:%zu\n", __func__, heredoc_line, heredoc_column);
+				config->error_type = LC_ERR_SYNTAX;
+				config->error_line = heredoc_line;
+				config->error_column = heredoc_column;
+				break;
+			}
+
+			name = heredoc.data;
+			terminator = name + strlen(name) + 1;
+			value = terminator + strlen(terminator) + 1;
+		}
+
+		index = TABLE_NPOS;
+
+		// collecting keeps every line, so the index is only probed for the other policies
+		if(config->duplicates != LC_DUP_COLLECT && (index = _table_find(config->table, name)) != TABLE_NPOS)
+		{
+			if(config->duplicates == LC_DUP_FIRST)
+				continue;
+
+			if(config->duplicates == LC_DUP_ERROR)
+			{
+				warning(stderr, "[WARNING] %s: duplicate name \"%s\" at %zu:%zu\n", __func__, name, name_line, name_column);
+				config->error_type = LC_ERR_DUPLICATE;
+				config->error_line = name_line;
+				config->error_column = name_column;
+				break;
+			}
+		}
+
+		// the value is checked once here, and the result is kept with the entry for typed reads
+		checked.valid = 0;
+
+		if(config->schema != NULL && (rule = _find_rule(config->schema, name, _hash_string(name))) != NULL &&
+			_is_checked_on_load(config, value))
+		{
+			if(_check_value(rule, rule->type, value, &checked) == LC_ERROR)
+			{
+				warning(stderr, "[WARNING] %s: invalid value of \"%s\" at %zu:%zu\n", __func__, name, name_line, value_column);
+				config->error_type = LC_ERR_INVALID;
+				config->error_line = name_line;
+				config->error_column = value_column;
+				break;
+			}
+		}
+
+		if(index != TABLE_NPOS)
+		{
+			// last wins
+			if(_load_replace_value(config, &state, index, value) == LC_ERROR)
+			{
+				config->error_type = LC_ERR_MEMORY_NO;
+				break;
+			}
+		}
+		else
+		{
+			if(_add_table_entry(config, name, value) == LC_ERROR)
+			{
+				config->error_type = LC_ERR_MEMORY_NO;
+				break;
+			}
+
+			index = config->table->count - 1;
+		}
+
+		if(checked.valid)
+		{
+			struct _lc_checked *flag = _table_reserve_checked(config->table, index);
+
+			if(flag == NULL)
+			{
+				config->error_type = LC_ERR_MEMORY_NO;
+				break;
+			}
+
+			*flag = checked;
+		}
+	}
+
+	funlockfile(fp);
+	_memory_free(buffer.data);
+	_memory_free(heredoc.data);
+	_finish_load(config, &state, result);
+
+	return result;
+}
+
+// files are written to path.tmp and renamed over path, so a crash never leaves a half written file
+// and a file mapped by lc_lazy_open() is not changed under it
+static char* _temp_path(struct _lc_memory *memory, const char *path)
+{
+	assert(path != NULL);
+
+	size_t length = strlen(path) + sizeof(".tmp");
+
+	char *temp_path = _memory_alloc(memory, length);
+	if(temp_path == NULL)
+		return NULL;
+
+	snprintf(temp_path, length, "%s.tmp", path);
+	return temp_path;
+}
+
+// makes the data of a closed file durable, it must be on disk before a rename makes it the file
+static int _sync_file(const char *path)
+{
+	assert(path != NULL);
+
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if(fd == -1)
+		return LC_ERROR;
+
+	int result = fsync(fd) == -1 ? LC_ERROR : LC_SUCCESS;
+
+	close(fd);
+	return result;
+}
+
+// closes the file written to temp_path and renames it over path, on failure it is removed
+static int _replace_file(lc_config_t *config, FILE *fp, const char *temp_path, const char *path)
+{
+	assert(config != NULL);
+	assert(fp != NULL);
+
+	if(fclose(fp) == EOF || _sync_file(temp_path) == LC_ERROR || rename(temp_path, path) == -1)
+	{
+		remove(temp_path);
+		config->error_type = LC_ERR_WRITE_NO;
+		return LC_ERROR;
+	}
+
+	return LC_SUCCESS;
+}
+
+// overrides are written only if with_overrides is set, the journal snapshot keeps the own values
+static int _dump_config_to_file(lc_config_t *config, FILE *fp, int with_overrides)
+{
+	assert(config != NULL);
+	assert(fp != NULL);
+
+	if(config->size == 0)
+	{
+		config->error_type = LC_ERR_EMPTY;
+		return LC_ERROR;
+	}
+
+	const struct _lc_config_table *table = config->table;
+
+	for(size_t i = 0; i < table->count; i++)
+	{
+		if(!_table_is_live(table, i))
+			continue;
+
+		if(_write_line_to_file(fp, _table_name(table, i)) == LC_ERROR ||
+			_write_line_to_file(fp, config->delim) == LC_ERROR ||
+			_write_value_to_file(fp, with_overrides ? _resolve_value(config, i) : _table_value(table, i)) == LC_ERROR ||
+			_write_line_to_file(fp, "\n") == LC_ERROR)
+		{
+			config->error_type = LC_ERR_WRITE_NO;
+			return LC_ERROR;
+		}
+	}
+
+	config->error_type = LC_ERR_NONE;
+	return LC_SUCCESS;
+}
+
+// functions for journal
+
+static void _free_interpolation(struct _lc_config_interpolation *interpolation)
+{
+	if(interpolation == NULL)
+		return;
+
+	_clear_expansions(interpolation);
+	_memory_free(interpolation->entries);
+	_memory_free(interpolation);
+}
+
+static void _free_overrides(struct _lc_config_overrides *overrides)
+{
+	if(overrides == NULL)
+		return;
+
+	_memory_free(overrides->env_prefix);
+	_memory_free(overrides);
+}
+
+// creates the override layer on first use
+static struct _lc_config_overrides* _get_overrides(lc_config_t *config)
+{
+	assert(config != NULL);
+
+	if(config->overrides == NULL)
+		config->overrides = _memory_zalloc(config->memory, sizeof(struct _lc_config_overrides));
+
+	return config->overrides;
+}
+
+static void _free_journal(struct _lc_config_journal *journal)
+{
+	if(journal == NULL)
+		return;
+
+	if(journal->fp != NULL)
+		fclose(journal->fp);
+
+	_memory_free(journal->path);
+	_memory_free(journal);
+}
+
+static int _write_journal_string(FILE *fp, const char *string)
+{
+	assert(fp != NULL);
+	assert(string != NULL);
+
+	// escape newlines, so one record is always one line
+	for(; *string != '\0'; string++)
+	{
+		if(*string == '\n' || *string == '\\')
+		{
+			if(fputc('\\', fp) == EOF || fputc(*string == '\n' ? 'n' : '\\', fp) == EOF)
+				return LC_ERROR;
+		}
+		else if(fputc(*string, fp) == EOF)
+		{
+			return LC_ERROR;
+		}
+	}
+
+	return LC_SUCCESS;
+}
+
+static void _unescape_journal_line(char *line)
+{
+	assert(line != NULL);
+
+	char *out = line;
+
+	for(char *in = line; *in != '\0'; in++)
+	{
+		if(*in == '\\' && in[1] != '\0')
+		{
+			in++;
+			*out++ = *in == 'n' ? '\n' : *in;
+		}
+		else
+		{
+			*out++ = *in;
+		}
+	}
+
+	*out = '\0';
+}
+
+// writes one record: <operation><name>[<delim><value>], replace also has the new name before the value
+static int _write_journal_record(FILE *fp, const char *delim, char operation, const char *name, const char *new_name, const char *value)
+{
+	assert(fp != NULL);
+	assert(name != NULL);
+
+	if(fputc(operation, fp) == EOF || _write_journal_string(fp, name) == LC_ERROR)
+		return LC_ERROR;
+
+	if(new_name != NULL && (_write_journal_string(fp, delim) == LC_ERROR || _write_journal_string(fp, new_name) == LC_ERROR))
+		return LC_ERROR;
+
+	if(value != NULL && (_write_journal_string(fp, delim) == LC_ERROR || _write_journal_string(fp, value) == LC_ERROR))
+		return LC_ERROR;
+
+	if(fputc('\n', fp) == EOF)
+		return LC_ERROR;
+
+	return LC_SUCCESS;
+}
+
+// flushes the records written since the last flush. if that fails, what was written of them is
+// dropped from the buffer and cut off the file, so a replay never sees a part of them and the next
+// record starts on its own line. a journal that can't be cut is closed
+static int _flush_journal(lc_config_t *config, int result)
+{
+	assert(config != NULL);
+
+	struct _lc_config_journal *journal = config->journal;
+
+	if(result == LC_SUCCESS && fflush(journal->fp) != EOF)
+	{
+		journal->size = ftello(journal->fp);
+		return LC_SUCCESS;
+	}
+
+	warning(stderr, "[WARNING] %s: failed to write journal record\n", __func__);
+	config->error_type = LC_ERR_WRITE_NO;
+
+	__fpurge(journal->fp);
+	clearerr(journal->fp);
+
+	if(ftruncate(fileno(journal->fp), journal->size) == -1 || fseeko(journal->fp, journal->size, SEEK_SET) == -1)
+	{
+		_free_journal(journal);
+		config->journal = NULL;
+	}
+
+	return LC_ERROR;
+}
+
+static int _journal_record(lc_config_t *config, char operation, const char *name, const char *new_name, const char *value)
+{
+	assert(config != NULL);
+	assert(name != NULL);
+
+	if(config->journal == NULL)
+		return LC_SUCCESS;
+
+	return _flush_journal(config, _write_journal_record(config->journal->fp, config->delim, operation, name, new_name, value));
+}
+
+// the records of a transaction are written between "{" and "}" lines and flushed at once, a replay
+// applies them only when the "}" line is there
+static int _journal_transaction(lc_config_t *config, const lc_transaction_t *transaction)
+{
+	assert(config != NULL);
+	assert(transaction != NULL);
+
+	if(config->journal == NULL || transaction->count == 0)
+		return LC_SUCCESS;
+
+	FILE *fp = config->journal->fp;
+	const char operations[] = { [LC_TXN_ADD] = '+', [LC_TXN_SET] = '=', [LC_TXN_DELETE] = '-' };
+	int result = fputs("{\n", fp) == EOF ? LC_ERROR : LC_SUCCESS;
+
+	for(size_t i = 0; i < transaction->count && result == LC_SUCCESS; i++)
+	{
+		const struct _lc_transaction_entry *entry = &transaction->entries[i];
+
+		result = _write_journal_record(fp, config->delim, operations[entry->operation], entry->name, NULL, entry->value);
+	}
+
+	if(result == LC_SUCCESS && fputs("}\n", fp) == EOF)
+		result = LC_ERROR;
+
+	return _flush_journal(config, result);
+}
+
+// a record inside a transaction group is staged in group, it is applied with the "}" line
+static int _replay_journal_line(lc_config_t *config, lc_transaction_t *group, char *line)
+{
+	assert(config != NULL);
+	assert(line != NULL);
+
+	char operation = line[0];
+	char *name = line + 1;
+	char *value = NULL;
+	char *new_name = NULL;
+
+	_unescape_journal_line(name);
+
+	if(operation != '-')
+	{
+		if((value = _find_delimiter(name, config->delim)) == NULL)
+			return LC_ERROR;
+
+		*value = '\0';
+		value += strlen(config->delim);
+	}
+
+	if(operation == '~')
+	{
+		new_name = value;
+
+		if((value = _find_delimiter(new_name, config->delim)) == NULL)
+			return LC_ERROR;
+
+		*value = '\0';
+		value += strlen(config->delim);
+	}
+
+	if(group != NULL)
+	{
+		int result = LC_ERROR;
+
+		if(operation == '+')
+			result = lc_transaction_add(group, name, value);
+		else if(operation == '=')
+			result = lc_transaction_set(group, name, value);
+		else if(operation == '-')
+			result = lc_transaction_delete(group, name);
+
+		return result;
+	}
+
+	size_t index = TABLE_NPOS;
+
+	switch(operation)
+	{
+	case '+':
+		return _add_table_entry(config, name, value);
+
+	case '=':
+		if((index = _find_table_index(config, name)) == TABLE_NPOS)
+			return LC_ERROR;
+
+		return _rewrite_table_entry_value(config, index, value);
+
+	case '-':
+		if((index = _find_table_index(config, name)) == TABLE_NPOS)
+			return LC_ERROR;
+
+		return _delete_table_entry(config, index);
+
+	case '~':
+		if((index = _find_table_index(config, name)) == TABLE_NPOS)
+			return LC_ERROR;
+
+		return _replace_table_entry(config, index, new_name, value);
+	}
+
+	return LC_ERROR;
+}
+
+// replays the records on top of the snapshot of the given generation, *generation is set to the
+// generation of the journal. a journal older than the snapshot was folded into it by a compaction
+// that stopped before emptying the journal, so its records are skipped and *stale is set.
+// records are only flushed, so a crash can leave the last one without its new line, or a
+// transaction without its "}" line. they are not replayed, and *end is set to where they start
+static int _replay_journal(lc_config_t *config, FILE *fp, uint64_t snapshot, uint64_t *generation, int *stale, off_t *end)
+{
+	assert(config != NULL);
+	assert(fp != NULL);
+	assert(generation != NULL);
+	assert(stale != NULL);
+	assert(end != NULL);
+
+	struct _lc_line_buffer buffer = { NULL, 0, 0 };
+	char *line = NULL;
+	lc_transaction_t *group = NULL;
+	int result = LC_SUCCESS;
+
+	*generation = snapshot;
+	*stale = 0;
+	*end = 0;
+
+	while(!*stale)
+	{
+		if(_read_line_from_file(config->memory, fp, &buffer, &line) == LC_ERROR)
+		{
+			config->error_type = LC_ERR_MEMORY_NO;
+			result = LC_ERROR;
+			break;
+		}
+
+		if(line == NULL || feof(fp))
+			break;
+
+		if(*line == '{' && line[1] == '\0' && group == NULL)
+		{
+			if((group = lc_begin_transaction(config)) == NULL)
+			{
+				result = LC_ERROR;
+				break;
+			}
+			continue;
+		}
+
+		if(*line == '}' && line[1] == '\0' && group != NULL)
+		{
+			result = lc_commit_transaction(group);
+			group = NULL;
+
+			if(result == LC_ERROR)
+			{
+				warning(stderr, "[WARNING] %s: cannot replay journal transaction\n", __func__);
+				break;
+			}
+
+			*end = ftello(fp);
+			continue;
+		}
+
+		if(group == NULL)
+			*end = ftello(fp);
+
+		if(*line == '\0')
+			continue;
+
+		if(*line == '@' && group == NULL)
+		{
+			uint64_t journal = strtoull(line + 1, NULL, 10);
+
+			if(journal < snapshot)
+				*stale = 1;
+			else
+				*generation = journal;
+			continue;
+		}
+
+		if(_replay_journal_line(config, group, line) == LC_ERROR)
+		{
+			warning(stderr, "[WARNING] %s: cannot replay journal record \"%s\"\n", __func__, line);
+			result = LC_ERROR;
+			break;
+		}
+	}
+
+	// a transaction that was not written whole is dropped
+	if(group != NULL)
+		lc_rollback_transaction(group);
+
+	_memory_free(buffer.data);
+
+	return result;
+}
+
+// generation from the marker on the first line of the snapshot, 0 if it has none
+static uint64_t _read_snapshot_generation(const char *filepath)
+{
+	unsigned long long generation = 0;
+
+	if(filepath == NULL)
+		return 0;
+
+	FILE *fp = fopen(filepath, "r");
+	if(fp == NULL)
+		return 0;
+
+	if(fscanf(fp, JOURNAL_MARKER "%llu", &generation) != 1)
+		generation = 0;
+
+	fclose(fp);
+	return (uint64_t)generation;
+}
+
+static int _write_journal_header(FILE *fp, uint64_t generation)
+{
+	assert(fp != NULL);
+
+	if(fprintf(fp, "@%llu\n", (unsigned long long)generation) < 0 || fflush(fp) == EOF || fsync(fileno(fp)) == -1)
+		return LC_ERROR;
+
+	return LC_SUCCESS;
+}
+
+// makes a rename in the directory of path durable
+static int _sync_directory(struct _lc_memory *memory, const char *path)
+{
+	assert(path != NULL);
+
+	const char *slash = strrchr(path, '/');
+	size_t length = slash == NULL ? 1 : slash == path ? 1 : (size_t)(slash - path);
+
+	char *directory = _memory_alloc(memory, length + 1);
+	if(directory == NULL)
+		return LC_ERROR;
+
+	memcpy(directory, slash == NULL ? "." : path, length);
+	directory[length] = '\0';
+
+	int fd = open(directory, O_RDONLY | O_DIRECTORY);
+	_memory_free(directory);
+
+	if(fd == -1)
+		return LC_ERROR;
+
+	int result = fsync(fd) == -1 ? LC_ERROR : LC_SUCCESS;
+
+	close(fd);
+	return result;
+}
+
+// functions for diff
+
+static lc_diff_t* _create_diff(const char *delim)
+{
+	assert(delim != NULL);
+
+	lc_diff_t *diff = _memory_zalloc(NULL, sizeof(lc_diff_t));
+	if(diff == NULL)
+		return NULL;
+
+	if((diff->delim = _memory_duplicate_string(NULL, delim)) == NULL)
+	{
+		_memory_free(diff);
+		return NULL;
+	}
+
+	return diff;
+}
+
+// value is NULL for removed names
+static int _diff_append(lc_diff_t *diff, lc_change_t change, const char *name, const char *value)
+{
+	assert(diff != NULL);
+	assert(name != NULL);
+
+	if(diff->count == diff->capacity)
+	{
+		size_t capacity = diff->capacity == 0 ? TABLE_SIZE : diff->capacity * 2;
+
+		struct _lc_diff_entry *entries = _memory_realloc(NULL, diff->entries, capacity * sizeof(struct _lc_diff_entry));
+		if(entries == NULL)
+			return LC_ERROR;
+
+		diff->entries = entries;
+		diff->capacity = capacity;
+	}
+
+	struct _lc_diff_entry *entry = &diff->entries[diff->count];
+
+	entry->change = change;
+	entry->value = NULL;
+
+	if((entry->name = _memory_duplicate_string(NULL, name)) == NULL)
+		return LC_ERROR;
+
+	if(value != NULL && (entry->value = _memory_duplicate_string(NULL, value)) == NULL)
+	{
+		_memory_free(entry->name);
+		return LC_ERROR;
+	}
+
+	diff->count++;
+	return LC_SUCCESS;
+}
+
+// true for live entries that lookups can find, the first of duplicate names
+static int _is_visible_entry(const struct _lc_config_table *table, size_t index)
+{
+	assert(table != NULL);
+
+	if(!_table_is_live(table, index))
+		return 0;
+
+	return _table_find_hashed(table, _table_name(table, index), _table_hash(table, index)) == index;
+}
+
+// records use the journal format: +name<delim>value, =name<delim>value, -name
+static int _parse_diff_line(lc_diff_t *diff, char *line)
+{
+	assert(diff != NULL);
+	assert(line != NULL);
+
+	char operation = line[0];
+	char *name = line + 1;
+	char *value = NULL;
+	lc_change_t change = LC_CHANGE_ADDED;
+
+	switch(operation)
+	{
+	case '+': change = LC_CHANGE_ADDED; break;
+	case '=': change = LC_CHANGE_CHANGED; break;
+	case '-': change = LC_CHANGE_REMOVED; break;
+	default:
+		return LC_ERROR;
+	}
+
+	_unescape_journal_line(name);
+
+	if(change != LC_CHANGE_REMOVED)
+	{
+		if((value = _find_delimiter(name, diff->delim)) == NULL)
+			return LC_ERROR;
+
+		*value = '\0';
+		value += strlen(diff->delim);
+	}
+
+	return _diff_append(diff, change, name, value);
+}
+
+// async io functions
+
+static void* _async_worker(void *argument)
+{
+	assert(argument != NULL);
+
+	lc_async_t *request = argument;
+
+	if(request->operation == LC_ASYNC_LOAD)
+		request->result = lc_load_config(request->config, request->filepath);
+	else
+		request->result = lc_dump_config(request->config, request->filepath);
+
+	if(request->callback != NULL)
+		request->callback(request->config, request->result, request->data);
+
+	uint64_t value = 1;
+	if(write(request->event_fd, &value, sizeof(value)) != sizeof(value))
+	{
+		warning(stderr, "[WARNING] %s: eventfd write failed\n", __func__);
+	}
+
+	return NULL;
+}
+
+static lc_async_t* _start_async_request(lc_config_t *config, const char *filepath, enum _lc_async_operation operation, lc_async_callback_t callback, void *data)
+{
+	assert(config != NULL);
+
+	lc_async_t *request = _memory_zalloc(NULL, sizeof(lc_async_t));
+	if(request == NULL)
+	{
+		config->error_type = LC_ERR_MEMORY_NO;
+		return NULL;
+	}
+
+	if(filepath != NULL && (request->filepath = _memory_duplicate_string(NULL, filepath)) == NULL)
+	{
+		_memory_free(request);
+		config->error_type = LC_ERR_MEMORY_NO;
+		return NULL;
+	}
+
+	request->operation = operation;
+	request->config = config;
+	request->callback = callback;
+	request->data = data;
+	request->result = LC_ERROR;
+
+	if((request->event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) == -1)
+	{
+		_memory_free(request->filepath);
+		_memory_free(request);
+		config->error_type = LC_ERR_FILE_NO;
+		return NULL;
+	}
+
+	if(pthread_create(&request->thread, NULL, _async_worker, request) != 0)
+	{
+		close(request->event_fd);
+		_memory_free(request->filepath);
+		_memory_free(request);
+		config->error_type = LC_ERR_MEMORY_NO;
+		return NULL;
+	}
+
+	return request;
+}
+
+// shared memory functions
+
+// "<name>.<generation>", returns NULL if memory runs out
+static char* _shm_data_name(const char *name, uint64_t generation)
+{
+	assert(name != NULL);
+
+	size_t length = strlen(name) + 22;
+
+	char *data_name = _memory_alloc(NULL, length);
+	if(data_name == NULL)
+		return NULL;
+
+	snprintf(data_name, length, "%s.%llu", name, (unsigned long long)generation);
+	return data_name;
+}
+
+// maps the whole segment, *size is set to its size. the segments are created readable by the owner only,
+// readers trust what they map
+static void* _shm_map(const char *name, int flags, size_t size, size_t *mapped_size)
+{
+	assert(name != NULL);
+
+	int fd = shm_open(name, flags, 0600);
+	if(fd == -1)
+		return NULL;
+
+	if(flags & O_CREAT)
+	{
+		if(ftruncate(fd, size) == -1)
+		{
+			close(fd);
+			return NULL;
+		}
+	}
+	else
+	{
+		struct stat info;
+
+		if(fstat(fd, &info) == -1 || (size_t)info.st_size < size)
+		{
+			close(fd);
+			return NULL;
+		}
+
+		size = info.st_size;
+	}
+
+	int protection = (flags & O_ACCMODE) == O_RDONLY ? PROT_READ : PROT_READ | PROT_WRITE;
+	void *address = mmap(NULL, size, protection, MAP_SHARED, fd, 0);
+
+	close(fd);
+
+	if(address == MAP_FAILED)
+		return NULL;
+
+	if(mapped_size != NULL)
+		*mapped_size = size;
+
+	return address;
+}
+
+static uint64_t _shm_bucket_count(uint64_t count)
+{
+	uint64_t bucket_count = TABLE_SIZE;
+
+	while(bucket_count < count * 2)
+		bucket_count *= 2;
+
+	return bucket_count;
+}
+
+// writes the flat index of the values seen by the getters into a new data segment
+static int _shm_write_segment(const lc_config_t *config, const char *data_name, uint64_t generation)
+{
+	assert(config != NULL);
+	assert(data_name != NULL);
+
+	const struct _lc_config_table *table = config->table;
+	uint64_t count = 0;
+	uint64_t strings_size = 0;
+
+	for(size_t i = 0; table != NULL && i < table->count; i++)
+	{
+		if(!_table_is_live(table, i))
+			continue;
+
+		const char *value = _lookup_value(config, i);
+		if(value == NULL)
+			return LC_ERROR;
+
+		strings_size += strlen(_table_name(table, i)) + strlen(value) + 2;
+		count++;
+	}
+
+	uint64_t bucket_count = _shm_bucket_count(count);
+	uint64_t entries_offset = sizeof(struct _lc_shm_header);
+	uint64_t buckets_offset = entries_offset + count * sizeof(struct _lc_shm_entry);
+	uint64_t strings_offset = buckets_offset + bucket_count * sizeof(uint64_t);
+	uint64_t size = strings_offset + strings_size;
+
+	char *segment = _shm_map(data_name, O_CREAT | O_EXCL | O_RDWR, size, NULL);
+	if(segment == NULL)
+		return LC_ERROR;
+
+	struct _lc_shm_header *header = (struct _lc_shm_header *)segment;
+	struct _lc_shm_entry *entries = (struct _lc_shm_entry *)(segment + entries_offset);
+	uint64_t *buckets = (uint64_t *)(segment + buckets_offset);
+	uint64_t offset = strings_offset;
+	uint64_t index = 0;
+
+	// ftruncate() gives a zeroed segment, so the buckets start empty
+	for(size_t i = 0; table != NULL && i < table->count; i++)
+	{
+		if(!_table_is_live(table, i))
+			continue;
+
+		const char *name = _table_name(table, i);
+		const char *value = _lookup_value(config, i);
+		size_t name_length = strlen(name);
+		size_t value_length = strlen(value);
+
+		entries[index].hash = _table_hash(table, i);
+		entries[index].name_offset = offset;
+		memcpy(segment + offset, name, name_length + 1);
+		offset += name_length + 1;
+
+		entries[index].value_offset = offset;
+		memcpy(segment + offset, value, value_length + 1);
+		offset += value_length + 1;
+
+		// entries are inserted in table order, so the first of duplicate names is found first
+		uint64_t bucket = entries[index].hash & (bucket_count - 1);
+		while(buckets[bucket] != 0)
+			bucket = (bucket + 1) & (bucket_count - 1);
+
+		buckets[bucket] = index + 1;
+		index++;
+	}
+
+	header->generation = generation;
+	header->size = size;
+	header->count = count;
+	header->bucket_count = bucket_count;
+	header->entries_offset = entries_offset;
+	header->buckets_offset = buckets_offset;
+	header->version = SHM_VERSION;
+	header->magic = SHM_MAGIC;
+
+	munmap(segment, size);
+	return LC_SUCCESS;
+}
+
+// checks that the index and the strings of a mapped data segment lie inside it and that every probe
+// chain ends, so lookups never read past the mapping
+static int _shm_check_segment(const struct _lc_shm_header *header, size_t size)
+{
+	assert(header != NULL);
+
+	const char *segment = (const char *)header;
+
+	if(header->magic != SHM_MAGIC || header->version != SHM_VERSION || header->size != size)
+		return LC_ERROR;
+
+	if(header->entries_offset < sizeof(struct _lc_shm_header) || header->entries_offset > size ||
+		header->entries_offset % _Alignof(struct _lc_shm_entry) != 0 ||
+		header->count > (size - header->entries_offset) / sizeof(struct _lc_shm_entry))
+		return LC_ERROR;
+
+	if(header->buckets_offset < sizeof(struct _lc_shm_header) || header->buckets_offset > size ||
+		header->buckets_offset % _Alignof(uint64_t) != 0 ||
+		header->bucket_count == 0 || (header->bucket_count & (header->bucket_count - 1)) != 0 ||
+		header->bucket_count > (size - header->buckets_offset) / sizeof(uint64_t) ||
+		header->count >= header->bucket_count)
+		return LC_ERROR;
+
+	const struct _lc_shm_entry *entries = (const struct _lc_shm_entry *)(segment + header->entries_offset);
+	const uint64_t *buckets = (const uint64_t *)(segment + header->buckets_offset);
+	uint64_t used = 0;
+
+	// at most count buckets are used, so at least one is empty
+	for(uint64_t i = 0; i < header->bucket_count; i++)
+	{
+		if(buckets[i] == 0)
+			continue;
+
+		if(buckets[i] > header->count || ++used > header->count)
+			return LC_ERROR;
+	}
+
+	for(uint64_t i = 0; i < header->count; i++)
+	{
+		uint64_t name_offset = entries[i].name_offset;
+		uint64_t value_offset = entries[i].value_offset;
+
+		if(name_offset >= size || memchr(segment + name_offset, '\0', size - name_offset) == NULL ||
+			value_offset >= size || memchr(segment + value_offset, '\0', size - value_offset) == NULL)
+			return LC_ERROR;
+	}
+
+	return LC_SUCCESS;
+}
+
+// maps the data segment of the current generation, retries if a new one is published meanwhile
+static const struct _lc_shm_header* _shm_attach_data(const char *name, const struct _lc_shm_control *control)
+{
+	assert(name != NULL);
+	assert(control != NULL);
+
+	while(1)
+	{
+		uint64_t generation = atomic_load(&control->generation);
+		size_t size = 0;
+
+		char *data_name = _shm_data_name(name, generation);
+		if(data_name == NULL)
+			return NULL;
+
+		const struct _lc_shm_header *header = _shm_map(data_name, O_RDONLY, sizeof(struct _lc_shm_header), &size);
+		_memory_free(data_name);
+
+		if(header != NULL)
+		{
+			if(_shm_check_segment(header, size) == LC_SUCCESS)
+				return header;
+
+			warning(stderr, "[WARNING] %s: broken shared memory segment\n", __func__);
+			munmap((void *)header, size);
+			return NULL;
+		}
+
+		// the segment is unlinked only after the next generation is published
+		if(errno != ENOENT || atomic_load(&control->generation) == generation)
+			return NULL;
+	}
+}
+
+// functions for lazy loading
+
+// a file truncated in place would fault on the mapped pages past its end
+static int _lazy_check_file(const lc_lazy_t *lazy)
+{
+	assert(lazy != NULL);
+
+	struct stat st;
+
+	if(fstat(lazy->fd, &st) == -1 || (uint64_t)st.st_size != (uint64_t)lazy->size)
+	{
+		warning(stderr, "[WARNING] %s: file changed since it was opened\n", __func__);
+		return LC_ERROR;
+	}
+
+	return LC_SUCCESS;
+}
+
+// names of decoded entries are compared with their copies, the others in the map, after the file is
+// checked. *found is TABLE_NPOS if there is no such name
+static int _lazy_find(const lc_lazy_t *lazy, const char *name, size_t name_length, uint32_t hash, size_t *found)
+{
+	assert(lazy != NULL);
+	assert(name != NULL);
+	assert(found != NULL);
+
+	*found = TABLE_NPOS;
+
+	if(lazy->index.bucket_count == 0)
+		return LC_SUCCESS;
+
+	size_t mask = lazy->index.bucket_count - 1;
+
+	// the scan of lc_lazy_open() reads the file it has just mapped
+	int checked = lazy->values == NULL;
+
+	for(size_t bucket = hash & mask; _index_bucket(&lazy->index, bucket) != 0; bucket = (bucket + 1) & mask)
+	{
+		size_t index = _index_bucket(&lazy->index, bucket) - 1;
+		const struct _lc_lazy_entry *entry = &lazy->entries[index];
+
+		if(entry->hash != hash || entry->name_length != name_length)
+			continue;
+
+		const char *key = lazy->values != NULL ? lazy->values[index] : NULL;
+
+		if(key == NULL)
+		{
+			if(!checked && _lazy_check_file(lazy) == LC_ERROR)
+				return LC_ERROR;
+
+			checked = 1;
+			key = lazy->map + entry->offset;
+		}
+
+		if(memcmp(key, name, name_length) == 0)
+		{
+			*found = index;
+			break;
+		}
+	}
+
+	return LC_SUCCESS;
+}
+
+static int _lazy_hash_of(const void *owner, size_t position, uint32_t *hash)
+{
+	*hash = ((const lc_lazy_t *)owner)->entries[position].hash;
+	return 1;
+}
+
+static int _lazy_append(lc_lazy_t *lazy, uint64_t offset, uint32_t hash, size_t name_length)
+{
+	assert(lazy != NULL);
+
+	struct _lc_memory *memory = lazy->config->memory;
+
+	if(lazy->count == lazy->capacity)
+	{
+		size_t capacity = lazy->capacity == 0 ? TABLE_SIZE : lazy->capacity * 2;
+
+		struct _lc_lazy_entry *entries = _memory_realloc(memory, lazy->entries, capacity * sizeof(struct _lc_lazy_entry));
+		if(entries == NULL)
+			return LC_ERROR;
+		lazy->entries = entries;
+		lazy->capacity = capacity;
+	}
+
+	if(_index_reserve(memory, &lazy->index, lazy->count + 1, lazy->count, _lazy_hash_of, lazy) == LC_ERROR)
+		return LC_ERROR;
+
+	lazy->entries[lazy->count].offset = offset;
+	lazy->entries[lazy->count].hash = hash;
+	lazy->entries[lazy->count].name_length = (uint32_t)name_length;
+
+	_index_insert(&lazy->index, hash, lazy->count++);
+	return LC_SUCCESS;
+}
+
+// copies the line at offset into the line buffer, *next is the offset of the line after it
+static int _lazy_read_line(lc_lazy_t *lazy, size_t offset, size_t *next)
+{
+	assert(lazy != NULL);
+	assert(next != NULL);
+
+	const char *start = lazy->map + offset;
+	const char *newline = memchr(start, '\n', lazy->size - offset);
+	size_t length = newline != NULL ? (size_t)(newline - start) : lazy->size - offset;
+
+	*next = offset + length + (newline != NULL);
+	lazy->line.length = 0;
+
+	return _append_line_buffer(lazy->config->memory, &lazy->line, start, length);
+}
+
+// reads the heredoc that starts at offset with the loader, *next is the offset after its terminator line
+static int _lazy_read_heredoc(lc_lazy_t *lazy, size_t offset, const char *name, const char *terminator,
+	size_t *line_number, size_t *next, int *closed)
+{
+	assert(lazy != NULL);
+	assert(next != NULL);
+	assert(closed != NULL);
+
+	*next = offset;
+	*closed = 0;
+
+	if(offset == lazy->size)
+		return LC_SUCCESS;
+
+	FILE *fp = fmemopen((void *)(lazy->map + offset), lazy->size - offset, "r");
+	if(fp == NULL)
+		return LC_ERROR;
+
+	int result = _read_heredoc(lazy->config->memory, fp, &lazy->line, &lazy->heredoc, name, terminator, line_number, closed);
+	*next = offset + (size_t)ftell(fp);
+
+	fclose(fp);
+	return result;
+}
+
+// one pass over the mapped file: every line and the rules of the schema are checked like
+// lc_load_config() does, but only the position and hash of the name are kept
+static int _lazy_build_index(lc_lazy_t *lazy)
+{
+	assert(lazy != NULL);
+
+	lc_config_t *config = lazy->config;
+	size_t offset = 0;
+	size_t next = 0;
+	size_t line_number = 0;
+	size_t column = 0;
+	char *name = NULL;
+	char *value = NULL;
+	char *terminator = NULL;
+	int closed = 0;
+	const struct _lc_rule *rule = NULL;
+	struct _lc_checked checked = { 0, LC_TYPE_STRING, { 0 } };
+
+	config->error_line = 0;
+	config->error_column = 0;
+
+	for(; offset < lazy->size; offset = next)
+	{
+		if(_lazy_read_line(lazy, offset, &next) == LC_ERROR)
+		{
+			config->error_type = LC_ERR_MEMORY_NO;
+			return LC_ERROR;
+		}
+
+		line_number++;
+
+		if((column = _tokenize_line(lazy->line.data, lazy->line.length, lazy->delim, &name, &value, &terminator)) != 0)
+		{
+			warning(stderr, "[WARNING] %s: syntax error at %zu:%zu\n", __func__, line_number, column);
+			config->error_type = LC_ERR_SYNTAX;
+			config->error_line = line_number;
+			config->error_column = column;
+			return LC_ERROR;
+		}
+
+		if(name == NULL)
+			continue;
+
+		size_t name_line = line_number;
+		size_t name_column = (size_t)(name - lazy->line.data) + 1;
+		size_t value_column = (size_t)(value - lazy->line.data) + 1;
+		uint64_t name_offset = offset + (uint64_t)(name - lazy->line.data);
+		size_t name_length = strlen(name);
+		uint32_t hash = _hash_string(name);
+
+		if(terminator != NULL)
+		{
+			size_t heredoc_line = line_number;
+			size_t heredoc_column = value_column;
+
+			if(_lazy_read_heredoc(lazy, next, name, terminator, &line_number, &next, &closed) == LC_ERROR)
+			{
+				config->error_type = LC_ERR_MEMORY_NO;
+				return LC_ERROR;
+			}
+
+			if(!closed)
+			{
+				warning(stderr, "[WARNING] %s: unterminated heredoc at %zu:%zu\n", __func__, heredoc_line, heredoc_column);
+				config->error_type = LC_ERR_SYNTAX;
+				config->error_line = heredoc_line;
+				config->error_column = heredoc_column;
+				return LC_ERROR;
+			}
+
+			// the line buffer was reused by the heredoc
+			name = lazy->heredoc.data;
+			terminator = name + strlen(name) + 1;
+			value = terminator + strlen(terminator) + 1;
+		}
+
+		size_t index = TABLE_NPOS;
+
+		if(config->duplicates != LC_DUP_COLLECT &&
+			_lazy_find(lazy, lazy->map + name_offset, name_length, hash, &index) == LC_SUCCESS && index != TABLE_NPOS)
+		{
+			if(config->duplicates == LC_DUP_FIRST)
+				continue;
+
+			if(config->duplicates == LC_DUP_ERROR)
+			{
+				warning(stderr, "[WARNING] %s: duplicate name at %zu:%zu\n", __func__, name_line, name_column);
+				config->error_type = LC_ERR_DUPLICATE;
+				config->error_line = name_line;
+				config->error_column = name_column;
+				return LC_ERROR;
+			}
+		}
+
+		// the parsed value is not kept, lazy values are read as strings
+		if(config->schema != NULL && (rule = _find_rule(config->schema, name, hash)) != NULL &&
+			_is_checked_on_load(config, value) && _check_value(rule, rule->type, value, &checked) == LC_ERROR)
+		{
+			warning(stderr, "[WARNING] %s: invalid value of \"%s\" at %zu:%zu\n", __func__, name, name_line, value_column);
+			config->error_type = LC_ERR_INVALID;
+			config->error_line = name_line;
+			config->error_column = value_column;
+			return LC_ERROR;
+		}
+
+		// last wins
+		if(index != TABLE_NPOS)
+		{
+			lazy->entries[index].offset = name_offset;
+			continue;
+		}
+
+		if(_lazy_append(lazy, name_offset, hash, name_length) == LC_ERROR)
+		{
+			config->error_type = LC_ERR_MEMORY_NO;
+			return LC_ERROR;
+		}
+	}
+
+	return LC_SUCCESS;
+}
+
+// decodes the value of an entry from its line (and the heredoc after it) on the first lookup
+static const char* _lazy_decode(lc_lazy_t *lazy, size_t index)
+{
+	assert(lazy != NULL);
+	assert(index < lazy->count);
+
+	lc_config_t *config = lazy->config;
+	const struct _lc_lazy_entry *entry = &lazy->entries[index];
+	size_t next = 0;
+	size_t line_number = 0;
+	char *name = NULL;
+	char *value = NULL;
+	char *terminator = NULL;
+	int closed = 0;
+
+	// the file was checked by the lookup that found the entry
+	config->error_type = LC_ERR_MEMORY_NO;
+
+	if(_lazy_read_line(lazy, (size_t)entry->offset, &next) == LC_ERROR)
+		return NULL;
+
+	// the line was checked when the index was built, unless the file was rewritten since then
+	if(_tokenize_line(lazy->line.data, lazy->line.length, lazy->delim, &name, &value, &terminator) != 0 ||
+		name != lazy->line.data || strlen(name) != entry->name_length || _hash_string(name) != entry->hash)
+	{
+		warning(stderr, "[WARNING] %s: file changed since it was opened\n", __func__);
+		config->error_type = LC_ERR_FILE_NO;
+		return NULL;
+	}
+
+	if(terminator != NULL)
+	{
+		if(_lazy_read_heredoc(lazy, next, name, terminator, &line_number, &next, &closed) == LC_ERROR)
+			return NULL;
+
+		if(!closed)
+		{
+			warning(stderr, "[WARNING] %s: file changed since it was opened\n", __func__);
+			config->error_type = LC_ERR_FILE_NO;
+			return NULL;
+		}
+
+		name = lazy->heredoc.data;
+		terminator = name + strlen(name) + 1;
+		value = terminator + strlen(terminator) + 1;
+	}
+
+	size_t value_length = strlen(value);
+
+	char *copy = _memory_alloc(config->memory, entry->name_length + value_length + 2);
+	if(copy == NULL)
+		return NULL;
+
+	memcpy(copy, name, entry->name_length + 1);
+	memcpy(copy + entry->name_length + 1, value, value_length + 1);
+
+	lazy->values[index] = copy;
+	lazy->decoded++;
+
+	config->error_type = LC_ERR_NONE;
+	return copy + entry->name_length + 1;
+}
+
+static int _copy_rules(lc_config_t *clone, const struct _lc_config_schema *schema)
+{
+	assert(clone != NULL);
+	assert(schema != NULL);
+
+	for(size_t i = 0; i < schema->count; i++)
+	{
+		const struct _lc_rule *rule = schema->rules[i];
+
+		if(lc_add_rule(clone, rule->name, rule->type) == LC_ERROR ||
+			(rule->has_range && lc_set_rule_range(clone, rule->name, rule->minimum, rule->maximum) == LC_ERROR) ||
+			(rule->pattern != NULL && lc_set_rule_pattern(clone, rule->name, rule->pattern) == LC_ERROR) ||
+			(rule->values != NULL && lc_set_rule_values(clone, rule->name, (const char * const *)rule->values, rule->value_count) == LC_ERROR))
+			return LC_ERROR;
+	}
+
+	return LC_SUCCESS;
+}
+
+// api functions
+
+int lc_init_config(lc_config_t *config, const char *filepath, const char *delim)
+{
+	if(config == NULL || delim == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+		return LC_ERROR;
+	}
+
+	config->table = NULL;
+	config->journal = NULL;
+	config->overrides = NULL;
+	config->interpolation = NULL;
+	config->profile = NULL;
+	config->schema = NULL;
+	config->size = 0;
+	config->duplicates = LC_DUP_COLLECT;
+	config->error_line = 0;
+	config->error_column = 0;
+	config->delim = NULL;
+
+	if((config->memory = _memory_create(&default_memory->allocator, 0)) == NULL)
+	{
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	if(filepath != NULL)
+	{
+		if((config->filepath = _memory_duplicate_string(config->memory, filepath)) == NULL)
+		{
+			_memory_release(config->memory);
+			config->error_type = LC_ERR_MEMORY_NO;
+			return LC_ERROR;
+		}
+	}
+	else
+	{
+		config->filepath = NULL;
+	}
+
+	if((config->delim = _memory_duplicate_string(config->memory, delim)) == NULL)
+	{
+		_memory_free(config->filepath);
+		_memory_release(config->memory);
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	config->error_type = LC_ERR_NONE;
+	return LC_SUCCESS;
+}
+
+int lc_load_config(lc_config_t *config, const char *filepath)
+{
+	if(config == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return LC_ERROR;
+	}
+
+	FILE *fp = NULL;
+
+	if(filepath == NULL) 
+	{
+		if(config->filepath == NULL)
+		{
+			config->error_type = LC_ERR_FILE_NO;
+			return LC_ERROR;
+		}
+
+		fp = _open_config_file(config->filepath, &config->error_type);
+	}
+	else 
+	{
+		fp = _open_config_file(filepath, &config->error_type);
+	}
+
+	if(fp == NULL)
+		return LC_ERROR;
+
+	if(_read_file_to_config(config, fp) == LC_ERROR)
+	{
+		fclose(fp);
+		return LC_ERROR;
+	}
+
+	fclose(fp);
+
+	return LC_SUCCESS;
+}
+
+int lc_load_config_stream(lc_config_t *config, FILE *fp)
+{
+	if(config == NULL || fp == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+
+		if(config != NULL)
+			config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	return _read_file_to_config(config, fp);
+}
+
+int lc_dump_config(lc_config_t *config, const char *filepath)
+{
+	if(config == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+		return LC_ERROR;
+	}
+
+	if(_check_names_to_dump(config) == LC_ERROR)
+		return LC_ERROR;
+
+	if(filepath == NULL && (filepath = config->filepath) == NULL)
+	{
+		config->error_type = LC_ERR_FILE_NO;
+		return LC_ERROR;
+	}
+
+	char *temp_path = _temp_path(config->memory, filepath);
+	if(temp_path == NULL)
+	{
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	FILE *fp = _file_open(temp_path, "w");
+	if(fp == NULL)
+	{
+		_memory_free(temp_path);
+		config->error_type = LC_ERR_FILE_NO;
+		return LC_ERROR;
+	}
+
+	if(_dump_config_to_file(config, fp, 1) == LC_ERROR)
+	{
+		fclose(fp);
+		remove(temp_path);
+		_memory_free(temp_path);
+		return LC_ERROR;
+	}
+
+	int result = _replace_file(config, fp, temp_path, filepath);
+
+	_memory_free(temp_path);
+	return result;
+}
+
+int lc_dump_config_compressed(lc_config_t *config, const char *filepath, lc_codec_t codec)
+{
+	if(config == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return LC_ERROR;
+	}
+
+	if(codec == LC_CODEC_NONE)
+		return lc_dump_config(config, filepath);
+
+	if(filepath == NULL && (filepath = config->filepath) == NULL)
+	{
+		config->error_type = LC_ERR_FILE_NO;
+		return LC_ERROR;
+	}
+
+	if(_check_names_to_dump(config) == LC_ERROR)
+		return LC_ERROR;
+
+	char *temp_path = _temp_path(config->memory, filepath);
+	if(temp_path == NULL)
+	{
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	FILE *fp = NULL;
+
+#if defined LC_HAVE_ZLIB
+	if(codec == LC_CODEC_GZIP)
+		fp = _gzip_open(gzopen(temp_path, "wb"), "w");
+#endif
+
+	if(fp == NULL)
+	{
+		remove(temp_path);
+		_memory_free(temp_path);
+		config->error_type = LC_ERR_FILE_NO;
+		return LC_ERROR;
+	}
+
+	if(_dump_config_to_file(config, fp, 1) == LC_ERROR)
+	{
+		fclose(fp);
+		remove(temp_path);
+		_memory_free(temp_path);
+		return LC_ERROR;
+	}
+
+	// the compressed tail is written on close
+	int result = _replace_file(config, fp, temp_path, filepath);
+
+	_memory_free(temp_path);
+	return result;
+}
+
+int lc_dump_config_stream(lc_config_t *config, FILE *fp)
+{
+	if(config == NULL || fp == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+
+		if(config != NULL)
+			config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	if(_check_names_to_dump(config) == LC_ERROR)
+		return LC_ERROR;
+
+	return _dump_config_to_file(config, fp, 1);
+}
+
+lc_async_t* lc_load_config_async(lc_config_t *config, const char *filepath, lc_async_callback_t callback, void *data)
+{
+	if(config == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return NULL;
+	}
+
+	return _start_async_request(config, filepath, LC_ASYNC_LOAD, callback, data);
+}
+
+lc_async_t* lc_dump_config_async(lc_config_t *config, const char *filepath, lc_async_callback_t callback, void *data)
+{
+	if(config == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return NULL;
+	}
+
+	return _start_async_request(config, filepath, LC_ASYNC_DUMP, callback, data);
+}
+
+int lc_async_get_fd(const lc_async_t *request)
+{
+	if(request == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return -1;
+	}
+
+	return request->event_fd;
+}
+
+int lc_async_wait(lc_async_t *request)
+{
+	if(request == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return LC_ERROR;
+	}
+
+	pthread_join(request->thread, NULL);
+
+	int result = request->result;
+
+	close(request->event_fd);
+	_memory_free(request->filepath);
+	_memory_free(request);
+
+	return result;
+}
+
+int lc_add_variable(lc_config_t *config, lc_config_variable_t *variable)
+{
+	if(config == NULL || variable == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+
+		if(config != NULL)
+			config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	lc_config_variable_t *variable_copy = NULL;
+
+	// the variable may point into the table, which the change can move
+	variable_copy = _create_variable_copy(config->memory, variable);
+	if(variable_copy == NULL)
+	{
+		warning(stderr, "[WARNING] %s: _create_variable_copy failed\n", __func__);
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	if(_check_journal_name(config, variable_copy->name) == LC_ERROR)
+	{
+		_free_config_variable(variable_copy);
+		return LC_ERROR;
+	}
+
+	int result = _add_table_entry(config, variable_copy->name, variable_copy->value);
+
+	if(result == LC_SUCCESS)
+		result = _journal_record(config, '+', variable_copy->name, NULL, variable_copy->value);
+
+	_free_config_variable(variable_copy);
+	return result;
+}
+
+int lc_delete_variable(lc_config_t *config, const char *name)
+{
+	if(config == NULL || name == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+
+		if(config != NULL)
+			config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+
+	if(config->size == 0)
+	{
+		config->error_type = LC_ERR_EMPTY;
+		return LC_ERROR;
+	}
+
+	size_t index = _find_table_index(config, name);
+	if(index == TABLE_NPOS)
+		return LC_ERROR;
+
+	// name may point into the table (an iterator or lc_get_variables()), which the delete can free,
+	// so the record is written from a copy
+	char *record_name = NULL;
+
+	if(config->journal != NULL && (record_name = _memory_duplicate_string(config->memory, name)) == NULL)
+	{
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	int result = _delete_table_entry(config, index);
+
+	if(result == LC_SUCCESS)
+		result = _journal_record(config, '-', record_name != NULL ? record_name : name, NULL, NULL);
+
+	_memory_free(record_name);
+	return result;
+}
+
+lc_existence_t lc_is_variable_in_config(lc_config_t *config, const char *name)
+{
+	if(config == NULL || name == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+
+		if(config != NULL)
+			config->error_type = LC_ERR_MEMORY_NO;
+		return LC_EF_ERROR;
+	}
+
+	if(config->size == 0)
+	{
+		config->error_type = LC_ERR_EMPTY;
+		return LC_EF_ERROR;
+	}
+
+	size_t index = _find_table_index(config, name);
+	if(index == TABLE_NPOS)
+		return LC_EF_NOT_EXISTS;
+
+	_record_access(config, index, 0);
+	return LC_EF_EXISTS;
+}
+
+int lc_set_variable(lc_config_t *config, const char *name, const char *new_value)
+{
+	if(config == NULL || name == NULL || new_value == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+
+		if(config != NULL)
+			config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	if(config->size == 0)
+	{
+		config->error_type = LC_ERR_EMPTY;
+		return LC_ERROR;
+	}
+
+	size_t index = _find_table_index(config, name);
+	if(index == TABLE_NPOS || _check_journal_name(config, name) == LC_ERROR)
+		return LC_ERROR;
+
+	// new_value may point into the table, which the change can move
+	char *value = _memory_duplicate_string(config->memory, new_value);
+	if(value == NULL)
+	{
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	int result = _rewrite_table_entry_value(config, index, value);
+	_memory_free(value);
+
+	if(result == LC_ERROR)
+		return LC_ERROR;
+
+	// the record is written from the table, name may have moved too
+	return _journal_record(config, '=', _table_name(config->table, index), NULL, _table_value(config->table, index));
+}
+
+lc_config_variable_t* lc_get_variable(lc_config_t *config, const char *name)
+{
+	if(config == NULL || name == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+
+		if(config != NULL)
+			config->error_type = LC_ERR_MEMORY_NO;
+		return NULL;
+	}
+
+	if(config->size == 0)
+	{
+		config->error_type = LC_ERR_EMPTY;
+		return NULL;
+	}
+
+	size_t index = _find_table_index(config, name);
+	if(index == TABLE_NPOS)
+		return NULL;
+
+	_record_access(config, index, 0);
+
+	lc_config_variable_t *variable = NULL;
+	const char *value = _lookup_value(config, index);
+
+	if(value != NULL)
+		variable = _make_config_variable(NULL, _table_name(config->table, index), value);
+
+	if(variable == NULL)
+		config->error_type = LC_ERR_MEMORY_NO;
+
+	return variable;
+}
+
+size_t lc_get_variables(lc_config_t *config, const char * const *names, size_t count, const char **values)
+{
+	if(config == NULL || names == NULL || values == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+
+		if(config != NULL)
+			config->error_type = LC_ERR_MEMORY_NO;
+		return 0;
+	}
+
+	const struct _lc_config_table *table = config->table;
+	size_t found = 0;
+
+	if(table == NULL || table->count == 0)
+	{
+		for(size_t i = 0; i < count; i++)
+			values[i] = NULL;
+
+		config->error_type = LC_ERR_EMPTY;
+		return 0;
+	}
+
+	size_t mask = table->index.bucket_count - 1;
+	uint32_t hashes[MULTI_GET_BATCH];
+
+	for(size_t base = 0; base < count; base += MULTI_GET_BATCH)
+	{
+		size_t batch = count - base < MULTI_GET_BATCH ? count - base : MULTI_GET_BATCH;
+
+		// hash the whole batch first, so the bucket loads overlap
+		for(size_t i = 0; i < batch; i++)
+		{
+			if(names[base + i] == NULL)
+				continue;
+
+			hashes[i] = _hash_string(names[base + i]);
+
+			size_t bucket = hashes[i] & mask;
+			prefetch(&table->index.pages[bucket / INDEX_PAGE]->buckets[bucket % INDEX_PAGE]);
+		}
+
+		for(size_t i = 0; i < batch; i++)
+		{
+			size_t index = TABLE_NPOS;
+
+			if(names[base + i] != NULL)
+				index = _table_find_hashed(table, names[base + i], hashes[i]);
+
+			if(index == TABLE_NPOS)
+			{
+				values[base + i] = NULL;
+				continue;
+			}
+
+			_record_access(config, index, 0);
+
+			if((values[base + i] = _lookup_value(config, index)) == NULL)
+			{
+				config->error_type = LC_ERR_MEMORY_NO;
+				return found;
+			}
+
+			found++;
+		}
+	}
+
+	config->error_type = found == count ? LC_ERR_NONE : LC_ERR_NOT_EXISTS;
+	return found;
+}
+
+size_t lc_get_variable_array(lc_config_t *config, const char *name, const char **values, size_t count)
+{
+	if(config == NULL || name == NULL || (values == NULL && count != 0))
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+
+		if(config != NULL)
+			config->error_type = LC_ERR_MEMORY_NO;
+		return 0;
+	}
+
+	const struct _lc_config_table *table = config->table;
+	size_t found = 0;
+
+	if(table == NULL || table->index.bucket_count == 0)
+	{
+		config->error_type = LC_ERR_EMPTY;
+		return 0;
+	}
+
+	// all entries with the same name are in one probe chain, in table order
+	uint32_t hash = _hash_string(name);
+	size_t mask = table->index.bucket_count - 1;
+
+	for(size_t bucket = hash & mask; _index_bucket(&table->index, bucket) != 0; bucket = (bucket + 1) & mask)
+	{
+		size_t index = _index_bucket(&table->index, bucket) - 1;
+
+		if(_table_hash(table, index) != hash || strcmp(_table_name(table, index), name) != 0)
+			continue;
+
+		// the array is one read of the name, counted on its first entry like other lookups
+		if(found == 0)
+			_record_access(config, index, 0);
+
+		if(found < count && (values[found] = _lookup_value(config, index)) == NULL)
+		{
+			config->error_type = LC_ERR_MEMORY_NO;
+			return found;
+		}
+
+		found++;
+	}
+
+	config->error_type = found != 0 ? LC_ERR_NONE : LC_ERR_NOT_EXISTS;
+	return found;
+}
+
+int lc_replace_variable(lc_config_t *config, const char *name, lc_config_variable_t *variable)
+{
+	if(config == NULL || name == NULL || variable == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+
+		if(config != NULL)
+			config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	if(config->size == 0)
+	{
+		config->error_type = LC_ERR_EMPTY;
+		return LC_ERROR;
+	}
+
+	size_t index = _find_table_index(config, name);
+	if(index == TABLE_NPOS || _check_journal_name(config, name) == LC_ERROR)
+		return LC_ERROR;
+
+	lc_config_variable_t *variable_copy = NULL;
+
+	variable_copy = _create_variable_copy(config->memory, variable);
+	if(variable_copy == NULL)
+	{
+		warning(stderr, "[WARNING] %s: _create_variable_copy failed\n", __func__);
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	if(_check_journal_name(config, variable_copy->name) == LC_ERROR)
+	{
+		_free_config_variable(variable_copy);
+		return LC_ERROR;
+	}
+
+	// name may point into the table, which the change can move, the record uses a copy of the old name
+	char *old_name = NULL;
+
+	if(config->journal != NULL && (old_name = _memory_duplicate_string(config->memory, name)) == NULL)
+	{
+		_free_config_variable(variable_copy);
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	int result = _replace_table_entry(config, index, variable_copy->name, variable_copy->value);
+
+	if(result == LC_SUCCESS)
+		result = _journal_record(config, '~', old_name != NULL ? old_name : name, variable_copy->name, variable_copy->value);
+
+	_memory_free(old_name);
+	_free_config_variable(variable_copy);
+	return result;
+}
+
+lc_transaction_t* lc_begin_transaction(lc_config_t *config)
+{
+	if(config == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return NULL;
+	}
+
+	lc_transaction_t *transaction = _memory_zalloc(config->memory, sizeof(lc_transaction_t));
+	if(transaction == NULL)
+	{
+		config->error_type = LC_ERR_MEMORY_NO;
+		return NULL;
+	}
+
+	transaction->config = config;
+	return transaction;
+}
+
+int lc_transaction_add(lc_transaction_t *transaction, const char *name, const char *value)
+{
+	if(transaction == NULL || name == NULL || value == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+		return LC_ERROR;
+	}
+
+	return _stage_transaction_entry(transaction, LC_TXN_ADD, name, value);
+}
+
+int lc_transaction_set(lc_transaction_t *transaction, const char *name, const char *new_value)
+{
+	if(transaction == NULL || name == NULL || new_value == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+		return LC_ERROR;
+	}
+
+	return _stage_transaction_entry(transaction, LC_TXN_SET, name, new_value);
+}
+
+int lc_transaction_delete(lc_transaction_t *transaction, const char *name)
+{
+	if(transaction == NULL || name == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+		return LC_ERROR;
+	}
+
+	return _stage_transaction_entry(transaction, LC_TXN_DELETE, name, NULL);
+}
+
+int lc_commit_transaction(lc_transaction_t *transaction)
+{
+	if(transaction == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return LC_ERROR;
+	}
+
+	lc_config_t *config = transaction->config;
+
+	if(_validate_transaction(config, transaction) == LC_ERROR)
+	{
+		_free_transaction(transaction);
+		return LC_ERROR;
+	}
+
+	if(_prepare_transaction(config, transaction) == LC_ERROR)
+	{
+		_free_transaction(transaction);
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	// applying can't fail, so the records are written first: if that fails, nothing is applied and the
+	// journal is cut back to where it was
+	if(_journal_transaction(config, transaction) == LC_ERROR)
+	{
+		_free_transaction(transaction);
+		return LC_ERROR;
+	}
+
+	_apply_transaction(config, transaction);
+	_free_transaction(transaction);
+
+	return LC_SUCCESS;
+}
+
+void lc_rollback_transaction(lc_transaction_t *transaction)
+{
+	if(transaction == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return;
+	}
+
+	_free_transaction(transaction);
+}
+
+void lc_print_config(const lc_config_t *config)
+{
+	if(config == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return;
+	}
+
+	if(config->size == 0)
+		return;
+
+	_print_table(config);
+}
+
+int lc_foreach_variable(const lc_config_t *config, const char *prefix, lc_variable_callback_t callback, void *data)
+{
+	if(config == NULL || callback == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+		return LC_ERROR;
+	}
+
+	const struct _lc_config_table *table = config->table;
+	if(table == NULL)
+		return LC_SUCCESS;
+
+	size_t prefix_length = prefix == NULL ? 0 : strlen(prefix);
+
+	for(size_t i = 0; i < table->count; i++)
+	{
+		if(!_table_is_live(table, i))
+			continue;
+
+		const char *name = _table_name(table, i);
+
+		if(prefix_length != 0 && strncmp(name, prefix, prefix_length) != 0)
+			continue;
+
+		const char *value = _lookup_value(config, i);
+		if(value == NULL)
+			return LC_ERROR;
+
+		if(callback(name, value, data) != 0)
+			break;
+	}
+
+	return LC_SUCCESS;
+}
+
+int lc_open_journal(lc_config_t *config, const char *journal_path)
+{
+	if(config == NULL || journal_path == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+
+		if(config != NULL)
+			config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	struct _lc_config_journal *journal = _memory_zalloc(config->memory, sizeof(struct _lc_config_journal));
+	if(journal == NULL)
+	{
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	if((journal->path = _memory_duplicate_string(config->memory, journal_path)) == NULL)
+	{
+		_free_journal(journal);
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	int result = LC_SUCCESS;
+	uint64_t snapshot = _read_snapshot_generation(config->filepath);
+	uint64_t generation = snapshot;
+	int stale = 0;
+	int empty = 1;
+	off_t end = 0;
+
+	// the table from before the replay is kept until the journal is open. if a record can't be
+	// applied, the replay is undone and the journal is not opened, so nothing is appended after it
+	struct _lc_config_table *saved = config->table;
+	size_t saved_size = config->size;
+
+	if(saved != NULL)
+		saved->refs++;
+
+	// records left from the last run are applied on top of the loaded snapshot
+	FILE *fp = fopen(journal_path, "r");
+	// the transactions replayed are not written to a journal that is already open
+	struct _lc_config_journal *open_journal = config->journal;
+	config->journal = NULL;
+
+	if(fp != NULL)
+	{
+		result = _replay_journal(config, fp, snapshot, &generation, &stale, &end);
+		empty = end == 0;
+		fclose(fp);
+	}
+
+	// a new or stale journal is started over for the generation of the snapshot, a torn record at the
+	// end is cut off, so the next one starts on its own line
+	int fresh = empty || stale;
+
+	if(result == LC_SUCCESS &&
+		((!fresh && truncate(journal_path, end) == -1) ||
+		(journal->fp = fopen(journal_path, fresh ? "w" : "a")) == NULL ||
+		(fresh && _write_journal_header(journal->fp, generation) == LC_ERROR) ||
+		(journal->size = ftello(journal->fp)) == -1))
+		result = LC_ERROR;
+
+	config->journal = open_journal;
+
+	if(result == LC_ERROR)
+	{
+		_table_release(config->table);
+		config->table = saved;
+		config->size = saved_size;
+
+		_reset_expansions(config);
+		_free_journal(journal);
+
+		if(config->error_type != LC_ERR_MEMORY_NO)
+			config->error_type = LC_ERR_FILE_NO;
+		return LC_ERROR;
+	}
+
+	_table_release(saved);
+
+	journal->generation = generation;
+
+	_free_journal(config->journal);
+	config->journal = journal;
+
+	config->error_type = LC_ERR_NONE;
+	return LC_SUCCESS;
+}
+
+int lc_compact_journal(lc_config_t *config)
+{
+	if(config == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return LC_ERROR;
+	}
+
+	if(config->journal == NULL || config->filepath == NULL)
+	{
+		config->error_type = LC_ERR_FILE_NO;
+		return LC_ERROR;
+	}
+
+	// the snapshot is replaced with rename(), so a crash leaves either the old or the new one. the new
+	// one has the next generation, so if the journal is not emptied, its records are not applied again
+	if(_check_names_to_dump(config) == LC_ERROR)
+		return LC_ERROR;
+
+	uint64_t generation = config->journal->generation + 1;
+
+	char *temp_path = _temp_path(config->memory, config->filepath);
+	if(temp_path == NULL)
+	{
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	FILE *fp = fopen(temp_path, "w");
+	if(fp == NULL)
+	{
+		_memory_free(temp_path);
+		config->error_type = LC_ERR_FILE_NO;
+		return LC_ERROR;
+	}
+
+	if(fprintf(fp, JOURNAL_MARKER "%llu\n", (unsigned long long)generation) < 0)
+	{
+		fclose(fp);
+		remove(temp_path);
+		_memory_free(temp_path);
+		config->error_type = LC_ERR_WRITE_NO;
+		return LC_ERROR;
+	}
+
+	if(config->size != 0 && _dump_config_to_file(config, fp, 0) == LC_ERROR)
+	{
+		fclose(fp);
+		remove(temp_path);
+		_memory_free(temp_path);
+		return LC_ERROR;
+	}
+
+	int result = _replace_file(config, fp, temp_path, config->filepath);
+
+	_memory_free(temp_path);
+
+	if(result == LC_ERROR)
+		return LC_ERROR;
+
+	// the journal is emptied only after the rename is durable. if that fails, records written from here
+	// would be skipped as stale next to the new snapshot, so the journal is closed
+	if(_sync_directory(config->memory, config->filepath) == LC_ERROR ||
+		(config->journal->fp = freopen(config->journal->path, "w", config->journal->fp)) == NULL ||
+		_write_journal_header(config->journal->fp, generation) == LC_ERROR ||
+		(config->journal->size = ftello(config->journal->fp)) == -1)
+	{
+		_free_journal(config->journal);
+		config->journal = NULL;
+		config->error_type = LC_ERR_FILE_NO;
+		return LC_ERROR;
+	}
+
+	config->journal->generation = generation;
+	config->error_type = LC_ERR_NONE;
+	return LC_SUCCESS;
+}
+
+void lc_close_journal(lc_config_t *config)
+{
+	if(config == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return;
+	}
+
+	_free_journal(config->journal);
+	config->journal = NULL;
+}
+
+int lc_set_env_overrides(lc_config_t *config, const char *prefix)
+{
+	if(config == NULL || prefix == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+
+		if(config != NULL)
+			config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	struct _lc_config_overrides *overrides = _get_overrides(config);
+	char *env_prefix = NULL;
+
+	if(overrides == NULL || (env_prefix = _memory_duplicate_string(config->memory, prefix)) == NULL)
+	{
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	_memory_free(overrides->env_prefix);
+	overrides->env_prefix = env_prefix;
+	_reset_expansions(config);
+
+	config->error_type = LC_ERR_NONE;
+	return LC_SUCCESS;
+}
+
+int lc_set_arg_overrides(lc_config_t *config, int argc, char * const *argv)
+{
+	if(config == NULL || argv == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+
+		if(config != NULL)
+			config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	struct _lc_config_overrides *overrides = _get_overrides(config);
+	if(overrides == NULL)
+	{
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	overrides->argv = argv;
+	overrides->argc = argc;
+	_reset_expansions(config);
+
+	config->error_type = LC_ERR_NONE;
+	return LC_SUCCESS;
+}
+
+int lc_set_interpolation(lc_config_t *config, int enable)
+{
+	if(config == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return LC_ERROR;
+	}
+
+	if(!enable)
+	{
+		_free_interpolation(config->interpolation);
+		config->interpolation = NULL;
+
+		config->error_type = LC_ERR_NONE;
+		return LC_SUCCESS;
+	}
+
+	if(config->interpolation == NULL)
+	{
+		config->interpolation = _memory_zalloc(config->memory, sizeof(struct _lc_config_interpolation));
+		if(config->interpolation == NULL)
+		{
+			config->error_type = LC_ERR_MEMORY_NO;
+			return LC_ERROR;
+		}
+	}
+
+	config->error_type = LC_ERR_NONE;
+	return LC_SUCCESS;
+}
+
+int lc_set_profiling(lc_config_t *config, unsigned int sample_rate)
+{
+	if(config == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return LC_ERROR;
+	}
+
+	// counts recorded so far are kept, so they can be reported after profiling is stopped
+	if(sample_rate == 0)
+	{
+		_memory_free(config->profile);
+		config->profile = NULL;
+
+		config->error_type = LC_ERR_NONE;
+		return LC_SUCCESS;
+	}
+
+	if(config->profile == NULL)
+	{
+		config->profile = _memory_alloc(config->memory, sizeof(struct _lc_config_profile));
+		if(config->profile == NULL)
+		{
+			config->error_type = LC_ERR_MEMORY_NO;
+			return LC_ERROR;
+		}
+	}
+
+	config->profile->sample_rate = sample_rate;
+	config->profile->countdown = sample_rate;
+
+	config->error_type = LC_ERR_NONE;
+	return LC_SUCCESS;
+}
+
+void lc_reset_profile(lc_config_t *config)
+{
+	if(config == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return;
+	}
+
+	struct _lc_config_table *table = config->table;
+
+	if(table == NULL || table->accesses == NULL)
+		return;
+
+	// counts of a table shared with a clone belong to both, the clone keeps its own
+	if(table->refs > 1)
+	{
+		if(_detach_config(config) == LC_ERROR)
+			return;
+
+		table = config->table;
+	}
+
+	_table_reset_accesses(table);
+}
+
+int lc_get_access_counts(const lc_config_t *config, const char *name, unsigned long long *reads, unsigned long long *writes, long long *accessed)
+{
+	if(config == NULL || name == NULL || reads == NULL || writes == NULL || accessed == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+		return LC_ERROR;
+	}
+
+	const struct _lc_config_table *table = config->table;
+
+	size_t index = _table_find(table, name);
+	if(index == TABLE_NPOS)
+		return LC_ERROR;
+
+	const struct _lc_access *access = _table_access(table, index);
+
+	if(access == NULL)
+	{
+		*reads = 0;
+		*writes = 0;
+		*accessed = 0;
+		return LC_SUCCESS;
+	}
+
+	*reads = access->reads;
+	*writes = access->writes;
+	*accessed = (long long)access->accessed;
+
+	return LC_SUCCESS;
+}
+
+int lc_dump_profile_stream(const lc_config_t *config, FILE *fp)
+{
+	if(config == NULL || fp == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+		return LC_ERROR;
+	}
+
+	const struct _lc_config_table *table = config->table;
+
+	if(fprintf(fp, "# reads\twrites\taccessed\tname\n") < 0)
+		return LC_ERROR;
+
+	if(table == NULL || table->count == 0 || table->accesses == NULL)
+		return LC_SUCCESS;
+
+	size_t count = 0;
+
+	struct _lc_hotness *order = _rank_by_hotness(table, &count);
+	if(order == NULL)
+		return LC_ERROR;
+
+	int result = LC_SUCCESS;
+
+	for(size_t i = 0; i < count; i++)
+	{
+		const struct _lc_access none = { 0, 0, 0 };
+		const struct _lc_access *access = _table_access(table, order[i].index);
+
+		if(access == NULL)
+			access = &none;
+
+		if(fprintf(fp, "%llu\t%llu\t%lld\t%s\n", (unsigned long long)access->reads, (unsigned long long)access->writes,
+			(long long)access->accessed, _table_name(table, order[i].index)) < 0)
+		{
+			result = LC_ERROR;
+			break;
+		}
+	}
+
+	_memory_free(order);
+	return result;
+}
+
+int lc_reorder_by_hotness(lc_config_t *config)
+{
+	if(config == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return LC_ERROR;
+	}
+
+	if(config->table == NULL || config->table->count < 2 || config->table->accesses == NULL)
+	{
+		config->error_type = LC_ERR_NONE;
+		return LC_SUCCESS;
+	}
+
+	if(_detach_config(config) == LC_ERROR)
+		return LC_ERROR;
+
+	struct _lc_config_table *table = config->table;
+	size_t count = 0;
+
+	// strings are packed in the new order, so hot names and values share cache lines.
+	// a failure leaves the old order, dead entries are dropped
+	struct _lc_hotness *order = _rank_by_hotness(table, &count);
+
+	if(order == NULL || _table_rebuild(table, order, count) == LC_ERROR)
+	{
+		_memory_free(order);
+
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	_memory_free(order);
+	_reset_expansions(config);
+
+	config->error_type = LC_ERR_NONE;
+	return LC_SUCCESS;
+}
+
+int lc_add_rule(lc_config_t *config, const char *name, lc_value_type_t type)
+{
+	if(config == NULL || name == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+
+		if(config != NULL)
+			config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	if(type < LC_TYPE_STRING || type > LC_TYPE_ENUM)
+	{
+		warning(stderr, "[WARNING] %s: invalid type\n", __func__);
+		config->error_type = LC_ERR_INVALID;
+		return LC_ERROR;
+	}
+
+	if(config->schema == NULL)
+	{
+		config->schema = _memory_zalloc(config->memory, sizeof(struct _lc_config_schema));
+		if(config->schema == NULL)
+		{
+			config->error_type = LC_ERR_MEMORY_NO;
+			return LC_ERROR;
+		}
+	}
+
+	uint32_t hash = _hash_string(name);
+	struct _lc_rule *rule = _find_rule(config->schema, name, hash);
+
+	// a rule added again starts over
+	if(rule != NULL)
+		_clear_rule(rule);
+	else if((rule = _create_rule(config->memory, config->schema, name, hash)) == NULL)
+	{
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	rule->type = type;
+	_uncheck_config(config);
+
+	config->error_type = LC_ERR_NONE;
+	return LC_SUCCESS;
+}
+
+int lc_set_rule_range(lc_config_t *config, const char *name, double minimum, double maximum)
+{
+	if(config == NULL || name == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+
+		if(config != NULL)
+			config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	struct _lc_rule *rule = _get_rule(config, name);
+	if(rule == NULL)
+		return LC_ERROR;
+
+	if(!(minimum <= maximum))
+	{
+		warning(stderr, "[WARNING] %s: invalid range\n", __func__);
+		config->error_type = LC_ERR_INVALID;
+		return LC_ERROR;
+	}
+
+	rule->has_range = 1;
+	rule->minimum = minimum;
+	rule->maximum = maximum;
+	_uncheck_config(config);
+
+	return LC_SUCCESS;
+}
+
+int lc_set_rule_pattern(lc_config_t *config, const char *name, const char *pattern)
+{
+	if(config == NULL || name == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+
+		if(config != NULL)
+			config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	struct _lc_rule *rule = _get_rule(config, name);
+	if(rule == NULL)
+		return LC_ERROR;
+
+	char *source = NULL;
+	regex_t regex;
+
+	if(pattern != NULL)
+	{
+		if((source = _memory_duplicate_string(config->memory, pattern)) == NULL)
+		{
+			config->error_type = LC_ERR_MEMORY_NO;
+			return LC_ERROR;
+		}
+
+		if(regcomp(&regex, pattern, REG_EXTENDED | REG_NOSUB) != 0)
+		{
+			warning(stderr, "[WARNING] %s: invalid pattern\n", __func__);
+			_memory_free(source);
+			config->error_type = LC_ERR_INVALID;
+			return LC_ERROR;
+		}
+	}
+
+	if(rule->pattern != NULL)
+	{
+		regfree(&rule->regex);
+		_memory_free(rule->pattern);
+	}
+
+	rule->pattern = source;
+	if(source != NULL)
+		rule->regex = regex;
+
+	_uncheck_config(config);
+	return LC_SUCCESS;
+}
+
+int lc_set_rule_values(lc_config_t *config, const char *name, const char * const *values, size_t count)
+{
+	if(config == NULL || name == NULL || (values == NULL && count != 0))
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+
+		if(config != NULL)
+			config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	struct _lc_rule *rule = _get_rule(config, name);
+	if(rule == NULL)
+		return LC_ERROR;
+
+	char **copies = NULL;
+
+	if(count != 0)
+	{
+		if((copies = _memory_zalloc(config->memory, count * sizeof(char *))) == NULL)
+		{
+			config->error_type = LC_ERR_MEMORY_NO;
+			return LC_ERROR;
+		}
+
+		for(size_t i = 0; i < count; i++)
+		{
+			if(values[i] == NULL || (copies[i] = _memory_duplicate_string(config->memory, values[i])) == NULL)
+			{
+				for(size_t j = 0; j < i; j++)
+					_memory_free(copies[j]);
+
+				_memory_free(copies);
+				config->error_type = values[i] == NULL ? LC_ERR_INVALID : LC_ERR_MEMORY_NO;
+				return LC_ERROR;
+			}
+		}
+	}
+
+	for(size_t i = 0; i < rule->value_count; i++)
+		_memory_free(rule->values[i]);
+
+	_memory_free(rule->values);
+
+	rule->values = copies;
+	rule->value_count = count;
+	_uncheck_config(config);
+
+	return LC_SUCCESS;
+}
+
+void lc_clear_rules(lc_config_t *config)
+{
+	if(config == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return;
+	}
+
+	_free_schema(config->schema);
+	config->schema = NULL;
+
+	_uncheck_config(config);
+}
+
+int lc_get_integer(lc_config_t *config, const char *name, long long *value)
+{
+	if(config == NULL || name == NULL || value == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+
+		if(config != NULL)
+			config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	struct _lc_checked checked;
+	unsigned int types = (1u << LC_TYPE_INTEGER) | (1u << LC_TYPE_BOOLEAN) | (1u << LC_TYPE_SIZE) | (1u << LC_TYPE_ENUM);
+
+	if(_get_checked_value(config, name, LC_TYPE_INTEGER, types, &checked) == LC_ERROR)
+		return LC_ERROR;
+
+	*value = checked.value.integer;
+
+	config->error_type = LC_ERR_NONE;
+	return LC_SUCCESS;
+}
+
+int lc_get_float(lc_config_t *config, const char *name, double *value)
+{
+	if(config == NULL || name == NULL || value == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+
+		if(config != NULL)
+			config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	struct _lc_checked checked;
+	unsigned int types = (1u << LC_TYPE_FLOAT) | (1u << LC_TYPE_INTEGER) | (1u << LC_TYPE_SIZE);
+
+	if(_get_checked_value(config, name, LC_TYPE_FLOAT, types, &checked) == LC_ERROR)
+		return LC_ERROR;
+
+	*value = checked.type == LC_TYPE_FLOAT ? checked.value.real : (double)checked.value.integer;
+
+	config->error_type = LC_ERR_NONE;
+	return LC_SUCCESS;
+}
+
+void lc_clear_overrides(lc_config_t *config)
+{
+	if(config == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return;
+	}
+
+	_free_overrides(config->overrides);
+	config->overrides = NULL;
+	_reset_expansions(config);
+}
+
+int lc_publish_config(lc_config_t *config, const char *name)
+{
+	if(config == NULL || name == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+
+		if(config != NULL)
+			config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	struct _lc_shm_control *control = _shm_map(name, O_CREAT | O_RDWR, sizeof(struct _lc_shm_control), NULL);
+	if(control == NULL)
+	{
+		config->error_type = LC_ERR_FILE_NO;
+		return LC_ERROR;
+	}
+
+	// a new control segment is zeroed
+	if(control->magic != SHM_MAGIC)
+	{
+		control->version = SHM_VERSION;
+		control->magic = SHM_MAGIC;
+	}
+
+	uint64_t old_generation = atomic_load(&control->generation);
+	uint64_t generation = old_generation + 1;
+	char *old_data_name = _shm_data_name(name, old_generation);
+	char *data_name = _shm_data_name(name, generation);
+
+	if(old_data_name == NULL || data_name == NULL)
+	{
+		_memory_free(old_data_name);
+		_memory_free(data_name);
+		munmap(control, sizeof(struct _lc_shm_control));
+		config->error_type = LC_ERR_MEMORY_NO;
+		return LC_ERROR;
+	}
+
+	// left by a publisher that failed before switching the generation
+	shm_unlink(data_name);
+
+	if(_shm_write_segment(config, data_name, generation) == LC_ERROR)
+	{
+		shm_unlink(data_name);
+		_memory_free(old_data_name);
+		_memory_free(data_name);
+		munmap(control, sizeof(struct _lc_shm_control));
+		config->error_type = LC_ERR_WRITE_NO;
+		return LC_ERROR;
+	}
+
+	// readers switch to the new segment from here, the old one lives while it is mapped
+	atomic_store(&control->generation, generation);
+
+	if(old_generation != 0)
+		shm_unlink(old_data_name);
+
+	_memory_free(old_data_name);
+	_memory_free(data_name);
+	munmap(control, sizeof(struct _lc_shm_control));
+
+	config->error_type = LC_ERR_NONE;
+	return LC_SUCCESS;
+}
+
+int lc_unpublish_config(const char *name)
+{
+	if(name == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return LC_ERROR;
+	}
+
+	struct _lc_shm_control *control = _shm_map(name, O_RDONLY, sizeof(struct _lc_shm_control), NULL);
+	if(control == NULL)
+		return LC_ERROR;
 
+	char *data_name = _shm_data_name(name, atomic_load(&control->generation));
+	munmap(control, sizeof(struct _lc_shm_control));
 
-	if(_find_delimiter(line, delim) == NULL)
-	{
-		free(dup_line);
-		warning(stderr, "[WARNING] %s: cannot find \"%s\" delimiter in line \"%s\"\n", __func__, delim, line);
-		return NULL;
-	}
+	if(data_name == NULL)
+		return LC_ERROR;
 
-	char *name = strtok(dup_line, delim);
-	char *value = strtok(NULL, delim);
+	shm_unlink(data_name);
+	_memory_free(data_name);
 
-	lc_config_variable_t *variable = _make_config_variable(name, value);
+	if(shm_unlink(name) == -1)
+		return LC_ERROR;
 
-	free(dup_line);
-	return variable;
+	return LC_SUCCESS;
 }
 
-static char* _convert_variable_to_line(lc_config_variable_t *variable, const char *delim)
+lc_shm_t* lc_shm_attach(const char *name)
 {
-	assert(variable != NULL);
-	assert(delim != NULL);
+	if(name == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return NULL;
+	}
 
-	// +2 because we also add: '\n', '\0'
-	size_t length = strlen(variable->name) + strlen(variable->value) + strlen(delim) + 2;
+	lc_shm_t *shm = _memory_zalloc(NULL, sizeof(lc_shm_t));
+	if(shm == NULL)
+		return NULL;
 
-	char *line = calloc(length, sizeof(char));
-	if(line == NULL) {
-		warning(stderr, "[ERROR] %s: allocation failed\n", __func__);
-		exit(EXIT_FAILURE);
+	if((shm->name = _memory_duplicate_string(NULL, name)) == NULL)
+	{
+		_memory_free(shm);
+		return NULL;
 	}
 
-	if(snprintf(line, length, "%s%s%s\n", variable->name, delim, variable->value) != ((int)length - 1))
+	shm->control = _shm_map(name, O_RDONLY, sizeof(struct _lc_shm_control), NULL);
+
+	if(shm->control == NULL || shm->control->magic != SHM_MAGIC || shm->control->version != SHM_VERSION ||
+		(shm->header = _shm_attach_data(name, shm->control)) == NULL)
 	{
-		free(line);
-		warning(stderr, "[WARNING] %s: snprintf() failed\n", __func__);
+		lc_shm_detach(shm);
 		return NULL;
 	}
 
-	return line;
+	return shm;
 }
 
-static void _print_list(struct _lc_config_list *list)
+void lc_shm_detach(lc_shm_t *shm)
 {
-	assert(list != NULL);
-
-	struct _lc_config_list *head = list;
-
-	while(head != NULL)
+	if(shm == NULL)
 	{
-		printf("%s=%s\n", head->variable->name, head->variable->value);
-		head = head->next;
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return;
 	}
-	printf("\n");
-}
 
-static int _add_list_element(lc_config_t *config, lc_config_variable_t *variable)
-{
-	assert(config != NULL);
-	assert(variable != NULL);
+	if(shm->header != NULL)
+		munmap((void *)shm->header, shm->header->size);
 
-	struct _lc_config_list *element = NULL;
+	if(shm->control != NULL)
+		munmap((void *)shm->control, sizeof(struct _lc_shm_control));
 
-	element = _create_list_element(variable);
-	if(element == NULL)
+	_memory_free(shm->name);
+	_memory_free(shm);
+}
+
+int lc_shm_refresh(lc_shm_t *shm)
+{
+	if(shm == NULL)
 	{
-		config->error_type = LC_ERR_MEMORY_NO;
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
 		return LC_ERROR;
 	}
 
-	if(config->list == NULL)
-	{
-		config->list = element;
-		config->error_type = LC_ERR_NONE;
-		config->list_size++;
+	if(atomic_load(&shm->control->generation) == shm->header->generation)
 		return LC_SUCCESS;
-	}
 
-	struct _lc_config_list *temp = config->list;
-	while(temp->next != NULL)
-		temp = temp->next;
+	const struct _lc_shm_header *header = _shm_attach_data(shm->name, shm->control);
+	if(header == NULL)
+		return LC_ERROR;
 
-	temp->next = element;
+	munmap((void *)shm->header, shm->header->size);
+	shm->header = header;
 
-	config->error_type = LC_ERR_NONE;
-	config->list_size++;
 	return LC_SUCCESS;
 }
 
-static struct _lc_config_list* _find_list_element(lc_config_t *config, const char *name)
+const char* lc_shm_get(const lc_shm_t *shm, const char *name)
 {
-	assert(config != NULL);
-	assert(name != NULL);
+	if(shm == NULL || name == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+		return NULL;
+	}
 
-	struct _lc_config_list *head = config->list;
+	const char *segment = (const char *)shm->header;
+	const struct _lc_shm_entry *entries = (const struct _lc_shm_entry *)(segment + shm->header->entries_offset);
+	const uint64_t *buckets = (const uint64_t *)(segment + shm->header->buckets_offset);
+	uint64_t mask = shm->header->bucket_count - 1;
+	uint32_t hash = _hash_string(name);
 
-	while(head != NULL)
+	for(uint64_t bucket = hash & mask; buckets[bucket] != 0; bucket = (bucket + 1) & mask)
 	{
-		if(strcmp(head->variable->name, name) == 0)
-		{
-			config->error_type = LC_ERR_NONE;
-			return head;
-		}
+		const struct _lc_shm_entry *entry = &entries[buckets[bucket] - 1];
 
-		head = head->next;
+		if(entry->hash == hash && strcmp(segment + entry->name_offset, name) == 0)
+			return segment + entry->value_offset;
 	}
 
-	config->error_type = LC_ERR_NOT_EXISTS;
 	return NULL;
 }
 
-static struct _lc_config_list* _find_prev_list_element(lc_config_t *config, const char *name)
+size_t lc_shm_get_size(const lc_shm_t *shm)
 {
-	assert(config != NULL);
-	assert(name != NULL);
-
-	struct _lc_config_list *prev = NULL;
-	struct _lc_config_list *head = config->list;
-
-	while(head != NULL)
+	if(shm == NULL)
 	{
-		if(strcmp(head->variable->name, name) == 0)
-		{
-			if(prev == NULL)
-			{
-				config->error_type = LC_ERR_NOT_EXISTS;
-				return NULL;
-			}
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return 0;
+	}
 
-			config->error_type = LC_ERR_NONE;
-			return prev;
-		}
+	return shm->header->count;
+}
 
-		prev = head;
-		head = head->next;
+unsigned long long lc_shm_get_generation(const lc_shm_t *shm)
+{
+	if(shm == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return 0;
 	}
 
-	config->error_type = LC_ERR_NOT_EXISTS;
-	return NULL;
+	return shm->header->generation;
 }
 
-static int _delete_list_element(lc_config_t *config, const char *name)
+lc_lazy_t* lc_lazy_open(lc_config_t *config, const char *filepath)
 {
-	assert(config != NULL);
-	assert(name != NULL);
+	if(config == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return NULL;
+	}
 
-	if(config->list == NULL)
+	if(filepath == NULL && (filepath = config->filepath) == NULL)
 	{
-		config->error_type = LC_ERR_EMPTY;
-		return LC_ERROR;
+		config->error_type = LC_ERR_FILE_NO;
+		return NULL;
+	}
+
+	lc_lazy_t *lazy = _memory_zalloc(config->memory, sizeof(lc_lazy_t));
+	if(lazy == NULL)
+	{
+		config->error_type = LC_ERR_MEMORY_NO;
+		return NULL;
 	}
 
-	struct _lc_config_list *temp = NULL;
-	struct _lc_config_list *element = NULL;
-	struct _lc_config_list *prev_element = NULL;
+	lazy->config = config;
+	lazy->fd = -1;
 
-	if((element = _find_list_element(config, name)) == NULL)
+	if((lazy->delim = _memory_duplicate_string(config->memory, config->delim)) == NULL)
 	{
-		config->error_type = LC_ERR_NOT_EXISTS;
-		return LC_ERROR;
+		lc_lazy_close(lazy);
+		config->error_type = LC_ERR_MEMORY_NO;
+		return NULL;
 	}
 
-	if((prev_element = _find_prev_list_element(config, name)) == NULL)
+	struct stat st;
+
+	if((lazy->fd = open(filepath, O_RDONLY | O_CLOEXEC)) == -1 || fstat(lazy->fd, &st) == -1)
 	{
-		config->list = config->list->next;
-		_free_list_element(element);
+		lc_lazy_close(lazy);
+		config->error_type = LC_ERR_FILE_NO;
+		return NULL;
+	}
 
-		config->error_type = LC_ERR_NONE;
-		config->list_size--;
-		return LC_SUCCESS;
+	// the file is read through the page cache, nothing is copied until a value is used
+	if(st.st_size > 0)
+	{
+		void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, lazy->fd, 0);
+
+		if(map != MAP_FAILED)
+		{
+			lazy->map = map;
+			lazy->size = (size_t)st.st_size;
+		}
+	}
+
+	if(st.st_size > 0 && lazy->map == NULL)
+	{
+		lc_lazy_close(lazy);
+		config->error_type = LC_ERR_FILE_NO;
+		return NULL;
+	}
+
+	if(lazy->map != NULL)
+		madvise((void *)lazy->map, lazy->size, MADV_SEQUENTIAL);
+
+	if(_lazy_build_index(lazy) == LC_ERROR)
+	{
+		lc_lazy_close(lazy);
+		return NULL;
 	}
 
-	temp = element;
-	prev_element->next = element->next;
+	if(lazy->count != 0 && (lazy->values = _memory_zalloc(config->memory, lazy->count * sizeof(char *))) == NULL)
+	{
+		lc_lazy_close(lazy);
+		config->error_type = LC_ERR_MEMORY_NO;
+		return NULL;
+	}
 
-	_free_list_element(temp);
+	// pages read by the scan are dropped, lookups map back only the lines they use
+	if(lazy->map != NULL)
+		madvise((void *)lazy->map, lazy->size, MADV_DONTNEED);
 
 	config->error_type = LC_ERR_NONE;
-	config->list_size--;
-	return LC_SUCCESS;
+	return lazy;
 }
 
-static void _delete_list(struct _lc_config_list *list)
+void lc_lazy_close(lc_lazy_t *lazy)
 {
-	if(list == NULL)
+	if(lazy == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
 		return;
+	}
 
-	struct _lc_config_list *head = list;
-	struct _lc_config_list *temp = NULL;
+	if(lazy->map != NULL)
+		munmap((void *)lazy->map, lazy->size);
 
-	while(head != NULL)
-	{
-		temp = head;
-		head = head->next;
+	if(lazy->fd != -1)
+		close(lazy->fd);
 
-		_free_list_element(temp);
+	if(lazy->values != NULL)
+	{
+		for(size_t i = 0; i < lazy->count; i++)
+			_memory_free(lazy->values[i]);
 	}
+
+	_memory_free(lazy->values);
+	_memory_free(lazy->entries);
+	_index_free(&lazy->index);
+	_memory_free(lazy->line.data);
+	_memory_free(lazy->heredoc.data);
+	_memory_free(lazy->delim);
+	_memory_free(lazy);
 }
 
-static int _rewrite_list_element_value(lc_config_t *config, const char *name, const char *new_value)
+const char* lc_lazy_get(lc_lazy_t *lazy, const char *name)
 {
-	assert(config != NULL);
-	assert(name != NULL);
-	assert(new_value != NULL);
+	if(lazy == NULL || name == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
 
-	struct _lc_config_list *element = NULL;
+		if(lazy != NULL)
+			lazy->config->error_type = LC_ERR_MEMORY_NO;
+		return NULL;
+	}
 
-	if((element = _find_list_element(config, name)) == NULL)
-		return LC_ERROR;
+	size_t index = TABLE_NPOS;
 
-	free(element->variable->value);
-	element->variable->value = _duplicate_string(new_value);
+	if(_lazy_find(lazy, name, strlen(name), _hash_string(name), &index) == LC_ERROR)
+	{
+		lazy->config->error_type = LC_ERR_FILE_NO;
+		return NULL;
+	}
 
-	config->error_type = LC_ERR_NONE;
-	return LC_SUCCESS;
+	if(index == TABLE_NPOS)
+	{
+		lazy->config->error_type = LC_ERR_NOT_EXISTS;
+		return NULL;
+	}
+
+	if(lazy->values[index] != NULL)
+	{
+		lazy->config->error_type = LC_ERR_NONE;
+		return lazy->values[index] + lazy->entries[index].name_length + 1;
+	}
+
+	return _lazy_decode(lazy, index);
 }
 
-static int _replace_variable_in_list(struct _lc_config_list *list, lc_config_variable_t *variable)
+size_t lc_lazy_get_size(const lc_lazy_t *lazy)
 {
-	assert(list != NULL);
-	assert(variable != NULL);
-
-	_free_config_variable(list->variable);
-	list->variable = variable;
+	if(lazy == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return (size_t)0;
+	}
 
-	return LC_SUCCESS;
+	return lazy->count;
 }
 
-// io functions
+size_t lc_lazy_get_decoded(const lc_lazy_t *lazy)
+{
+	if(lazy == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return (size_t)0;
+	}
 
-static int _read_file_to_config(lc_config_t *config, FILE *fp)
+	return lazy->decoded;
+}
+
+lc_diff_t* lc_diff_configs(const lc_config_t *from, const lc_config_t *to)
 {
-	assert(config != NULL);
-	assert(fp != NULL);
+	if(from == NULL || to == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+		return NULL;
+	}
 
-	char *line = NULL;
-	lc_config_variable_t * variable = NULL;
+	lc_diff_t *diff = _create_diff(to->delim);
+	if(diff == NULL)
+		return NULL;
+
+	const struct _lc_config_table *from_table = from->table;
+	const struct _lc_config_table *to_table = to->table;
 
-	while((line = _read_line_from_file(fp)) != NULL)
+	// every name is looked up once in the other index, with the hash already stored
+	for(size_t i = 0; from_table != NULL && i < from_table->count; i++)
 	{
-		if((variable = _convert_line_to_variable(line, config->delim)) == NULL)
-		{
-			free(line);
-			config->error_type = LC_ERR_MEMORY_NO;
-			// if it can't convert line to variable, it's just skip this line
+		if(!_is_visible_entry(from_table, i))
 			continue;
-		}
 
-		if(_add_list_element(config, variable) == LC_ERROR)
+		const char *name = _table_name(from_table, i);
+		const char *value = _table_value(from_table, i);
+		size_t index = _table_find_hashed(to_table, name, _table_hash(from_table, i));
+		int result = LC_SUCCESS;
+
+		if(index == TABLE_NPOS)
+			result = _diff_append(diff, LC_CHANGE_REMOVED, name, NULL);
+		else if(strcmp(value, _table_value(to_table, index)) != 0)
+			result = _diff_append(diff, LC_CHANGE_CHANGED, name, _table_value(to_table, index));
+
+		if(result == LC_ERROR)
 		{
-			free(line);
-			free(variable);
-			return LC_ERROR;
+			lc_free_diff(diff);
+			return NULL;
 		}
+	}
+
+	for(size_t i = 0; to_table != NULL && i < to_table->count; i++)
+	{
+		if(!_is_visible_entry(to_table, i))
+			continue;
 
-		free(line);
+		const char *name = _table_name(to_table, i);
+
+		if(_table_find_hashed(from_table, name, _table_hash(to_table, i)) != TABLE_NPOS)
+			continue;
+
+		if(_diff_append(diff, LC_CHANGE_ADDED, name, _table_value(to_table, i)) == LC_ERROR)
+		{
+			lc_free_diff(diff);
+			return NULL;
+		}
 	}
 
-	return LC_SUCCESS;
+	return diff;
 }
 
-static int _dump_config_to_file(lc_config_t *config, FILE *fp)
+void lc_free_diff(lc_diff_t *diff)
 {
-	assert(config != NULL);
-	assert(fp != NULL);
+	if(diff == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return;
+	}
 
-	if(config->list == NULL)
+	for(size_t i = 0; i < diff->count; i++)
 	{
-		config->error_type = LC_ERR_EMPTY;
-		return LC_ERROR;
+		_memory_free(diff->entries[i].name);
+		_memory_free(diff->entries[i].value);
 	}
 
-	char *line = NULL;
-	struct _lc_config_list *head = config->list;
+	_memory_free(diff->entries);
+	_memory_free(diff->delim);
+	_memory_free(diff);
+}
 
-	while(head != NULL)
+size_t lc_diff_get_size(const lc_diff_t *diff)
+{
+	if(diff == NULL)
 	{
-		if((line = _convert_variable_to_line(head->variable, config->delim)) == NULL)
-		{
-			config->error_type = LC_ERR_MEMORY_NO;
-			return LC_ERROR;
-		}
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return 0;
+	}
 
-		if(_write_line_to_file(fp, line) == LC_ERROR)
-		{
-			free(line);
-			config->error_type = LC_ERR_WRITE_NO;
-			return LC_ERROR;
-		}
+	return diff->count;
+}
 
-		free(line);
-		head = head->next;
+int lc_diff_get_change(const lc_diff_t *diff, size_t index, lc_change_t *change, const char **name, const char **value)
+{
+	if(diff == NULL || change == NULL || name == NULL || value == NULL)
+	{
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+		return LC_ERROR;
 	}
 
-	config->error_type = LC_ERR_NONE;
+	if(index >= diff->count)
+		return LC_ERROR;
+
+	*change = diff->entries[index].change;
+	*name = diff->entries[index].name;
+	*value = diff->entries[index].value;
+
 	return LC_SUCCESS;
 }
 
-// api functions
-
-int lc_init_config(lc_config_t *config, const char *filepath, const char *delim)
+int lc_dump_diff_stream(const lc_diff_t *diff, FILE *fp)
 {
-	if(config == NULL || delim == NULL)
+	if(diff == NULL || fp == NULL)
 	{
 		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
 		return LC_ERROR;
 	}
 
-	config->list = NULL;
-	config->list_size = 0;
-	config->delim = NULL;
+	static const char operations[] = { '+', '-', '=' };
 
-	if(filepath != NULL)
+	for(size_t i = 0; i < diff->count; i++)
 	{
-		if((config->filepath = _duplicate_string(filepath)) == NULL)
-		{
-			config->error_type = LC_ERR_MEMORY_NO;
+		const struct _lc_diff_entry *entry = &diff->entries[i];
+
+		if(fputc(operations[entry->change], fp) == EOF || _write_journal_string(fp, entry->name) == LC_ERROR)
 			return LC_ERROR;
+
+		if(entry->value != NULL)
+		{
+			if(_write_journal_string(fp, diff->delim) == LC_ERROR || _write_journal_string(fp, entry->value) == LC_ERROR)
+				return LC_ERROR;
 		}
-	}
-	else
-	{
-		config->filepath = NULL;
-	}
 
-	if((config->delim = _duplicate_string(delim)) == NULL)
-	{
-		free(config->filepath);
-		config->error_type = LC_ERR_MEMORY_NO;
-		return LC_ERROR;
+		if(fputc('\n', fp) == EOF)
+			return LC_ERROR;
 	}
 
-	config->error_type = LC_ERR_NONE;
 	return LC_SUCCESS;
 }
 
-int lc_load_config(lc_config_t *config, const char *filepath)
+lc_diff_t* lc_load_diff_stream(FILE *fp, const char *delim)
 {
-	if(config == NULL)
+	if(fp == NULL || delim == NULL)
 	{
-		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
-		return LC_ERROR;
+		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+		return NULL;
 	}
 
-	FILE *fp = NULL;
+	struct _lc_line_buffer buffer = { NULL, 0, 0 };
+	char *line = NULL;
 
-	if(filepath == NULL) 
+	lc_diff_t *diff = _create_diff(delim);
+	if(diff == NULL)
+		return NULL;
+
+	while(1)
 	{
-		if(config->filepath == NULL)
+		if(_read_line_from_file(NULL, fp, &buffer, &line) == LC_ERROR)
+			break;
+
+		if(line == NULL)
 		{
-			config->error_type = LC_ERR_FILE_NO;
-			return LC_ERROR;
+			_memory_free(buffer.data);
+			return diff;
 		}
 
-		fp = _file_open(config->filepath, "r");
-	}
-	else 
-	{
-		fp = _file_open(filepath, "r");
-	}
-
-	if(fp == NULL)
-	{
-		config->error_type = LC_ERR_FILE_NO;
-		return LC_ERROR;
-	}
+		if(*line == '\0')
+			continue;
 
-	if(_read_file_to_config(config, fp) == LC_ERROR)
-	{
-		fclose(fp);
-		return LC_ERROR;
+		if(_parse_diff_line(diff, line) == LC_ERROR)
+		{
+			warning(stderr, "[WARNING] %s: broken diff record \"%s\"\n", __func__, line);
+			break;
+		}
 	}
 
-	fclose(fp);
+	_memory_free(buffer.data);
+	lc_free_diff(diff);
 
-	return LC_SUCCESS;
+	return NULL;
 }
 
-int lc_load_config_stream(lc_config_t *config, FILE *fp)
+int lc_apply_diff(lc_config_t *config, const lc_diff_t *diff)
 {
-	if(config == NULL || fp == NULL)
+	if(config == NULL || diff == NULL)
 	{
 		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+		return LC_ERROR;
+	}
 
-		if(config != NULL)
-			config->error_type = LC_ERR_MEMORY_NO;
+	// the whole diff is one transaction, so it is applied completely or not at all
+	lc_transaction_t *transaction = lc_begin_transaction(config);
+	if(transaction == NULL)
 		return LC_ERROR;
+
+	for(size_t i = 0; i < diff->count; i++)
+	{
+		const struct _lc_diff_entry *entry = &diff->entries[i];
+		int result = LC_ERROR;
+
+		switch(entry->change)
+		{
+		case LC_CHANGE_ADDED:
+			result = lc_transaction_add(transaction, entry->name, entry->value);
+			break;
+
+		case LC_CHANGE_REMOVED:
+			result = lc_transaction_delete(transaction, entry->name);
+			break;
+
+		case LC_CHANGE_CHANGED:
+			result = lc_transaction_set(transaction, entry->name, entry->value);
+			break;
+		}
+
+		if(result == LC_ERROR)
+		{
+			lc_rollback_transaction(transaction);
+			config->error_type = LC_ERR_MEMORY_NO;
+			return LC_ERROR;
+		}
 	}
 
-	return _read_file_to_config(config, fp);
+	return lc_commit_transaction(transaction);
 }
 
-int lc_dump_config(lc_config_t *config, const char *filepath)
+int lc_clone_config(lc_config_t *clone, const lc_config_t *config)
 {
-	if(config == NULL)
+	if(clone == NULL || config == NULL)
 	{
 		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
 		return LC_ERROR;
 	}
 
-	FILE *fp = NULL;
+	if(lc_init_config(clone, config->filepath, config->delim) == LC_ERROR)
+		return LC_ERROR;
 
-	if(filepath == NULL) 
+	// the table is shared until one of the configs is changed
+	clone->table = config->table;
+	clone->size = config->size;
+	clone->duplicates = config->duplicates;
+
+	if(clone->table != NULL)
+		clone->table->refs++;
+
+	if(config->overrides != NULL)
 	{
-		if(config->filepath == NULL)
+		if((config->overrides->env_prefix != NULL && lc_set_env_overrides(clone, config->overrides->env_prefix) == LC_ERROR) ||
+			(config->overrides->argv != NULL && lc_set_arg_overrides(clone, config->overrides->argc, config->overrides->argv) == LC_ERROR))
 		{
-			config->error_type = LC_ERR_FILE_NO;
+			lc_clear_config(clone);
 			return LC_ERROR;
 		}
-
-		fp = _file_open(config->filepath, "w");
-	}
-	else 
-	{
-		fp = _file_open(filepath, "w");
 	}
 
-	if(fp == NULL)
+	if(config->interpolation != NULL && lc_set_interpolation(clone, 1) == LC_ERROR)
 	{
-		config->error_type = LC_ERR_FILE_NO;
+		lc_clear_config(clone);
 		return LC_ERROR;
 	}
 
-	if(_dump_config_to_file(config, fp) == LC_ERROR)
+	if(config->schema != NULL && _copy_rules(clone, config->schema) == LC_ERROR)
 	{
-		fclose(fp);
+		lc_clear_config(clone);
 		return LC_ERROR;
 	}
 
-	fclose(fp);
-
 	return LC_SUCCESS;
 }
 
-int lc_dump_config_stream(lc_config_t *config, FILE *fp)
+char* lc_get_error(const lc_config_t *config)
 {
-	if(config == NULL || fp == NULL)
+	if(config == NULL)
 	{
-		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return NULL;
+	}
 
-		if(config != NULL)
-			config->error_type = LC_ERR_MEMORY_NO;
-		return LC_ERROR;
+	if(config->error_type < 0 || config->error_type > LC_ERR_INVALID)
+	{
+		warning(stderr, "[ERROR] %s: invalid error index\n", __func__);
+		return NULL;
 	}
 
-	return _dump_config_to_file(config, fp);
+	return _duplicate_string(error_msg[config->error_type]);
 }
 
-int lc_add_variable(lc_config_t *config, lc_config_variable_t *variable)
+int lc_get_error_position(const lc_config_t *config, size_t *line, size_t *column)
 {
-	if(config == NULL || variable == NULL)
+	if(config == NULL || line == NULL || column == NULL)
 	{
 		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
-
-		if(config != NULL)
-			config->error_type = LC_ERR_MEMORY_NO;
 		return LC_ERROR;
 	}
 
-	lc_config_variable_t *variable_copy = NULL;
+	if(config->error_type != LC_ERR_SYNTAX && config->error_type != LC_ERR_DUPLICATE && config->error_type != LC_ERR_INVALID)
+		return LC_ERROR;
 
-	variable_copy = _create_variable_copy(variable);
-	if(variable_copy == NULL)
-	{
-		warning(stderr, "[WARNING] %s: _create_variable_copy failed\n", __func__);
-		config->error_type = LC_ERR_MEMORY_NO;
+	// values checked on read have no position in the file
+	if(config->error_line == 0)
 		return LC_ERROR;
+
+	*line = config->error_line;
+	*column = config->error_column;
+
+	return LC_SUCCESS;
+}
+
+void lc_clear_config(lc_config_t *config)
+{
+	if(config == NULL) {
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return;
 	}
 
-	if(_add_list_element(config, variable_copy) == LC_ERROR)
-	{
-		free(variable);
-		return LC_ERROR;
+	// the table may still be used by a clone
+	_table_release(config->table);
+
+	_free_journal(config->journal);
+	_free_overrides(config->overrides);
+	_free_interpolation(config->interpolation);
+	_memory_free(config->profile);
+	_free_schema(config->schema);
+
+	_memory_free(config->filepath);
+	_memory_free(config->delim);
+	_memory_release(config->memory);
+
+	config->memory = NULL;
+	config->table = NULL;
+	config->journal = NULL;
+	config->overrides = NULL;
+	config->interpolation = NULL;
+	config->profile = NULL;
+	config->schema = NULL;
+	config->size = 0;
+	config->error_type = LC_ERR_NONE;
+	config->filepath = NULL;
+}
+
+char* lc_get_delim(lc_config_t *config)
+{
+	if(config == NULL) {
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return NULL;
 	}
 
-	return LC_SUCCESS;
+	return _duplicate_string(config->delim);
 }
 
-int lc_delete_variable(lc_config_t *config, const char *name)
+int lc_set_delim(lc_config_t *config, const char *delim)
 {
-	if(config == NULL || name == NULL)
-	{
+	if(config == NULL || delim == NULL) {
 		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
 
 		if(config != NULL)
@@ -711,130 +7256,162 @@ int lc_delete_variable(lc_config_t *config, const char *name)
 		return LC_ERROR;
 	}
 
-
-	if(config->list == NULL)
+	char *new_delim = _memory_duplicate_string(config->memory, delim);
+	if(new_delim == NULL)
 	{
-		config->error_type = LC_ERR_EMPTY;
+		config->error_type = LC_ERR_MEMORY_NO;
 		return LC_ERROR;
 	}
 
-	if((_delete_list_element(config, name)) == LC_ERROR)
-		return LC_ERROR;
+	_memory_free(config->delim);
+	config->delim = new_delim;
 
 	return LC_SUCCESS;
 }
 
-lc_existence_t lc_is_variable_in_config(lc_config_t *config, const char *name)
+int lc_set_default_allocator(const lc_allocator_t *allocator)
 {
-	if(config == NULL || name == NULL)
+	struct _lc_memory *memory = &malloc_memory;
+
+	if(allocator != NULL)
 	{
-		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
+		if(allocator->alloc == NULL || allocator->realloc == NULL || allocator->free == NULL)
+		{
+			warning(stderr, "[WARNING] %s: allocator functions is null\n", __func__);
+			return LC_ERROR;
+		}
 
-		if(config != NULL)
-			config->error_type = LC_ERR_MEMORY_NO;
-		return LC_EF_ERROR;
-	}
+		if((memory = _memory_create(allocator, 0)) == NULL)
+			return LC_ERROR;
 
-	if(config->list == NULL)
-	{
-		config->error_type = LC_ERR_EMPTY;
-		return LC_EF_ERROR;
+		memory->shared = 1;
 	}
+	else
+		atomic_fetch_add(&memory->refs, 1);
 
-	struct _lc_config_list *head = NULL;
+	// blocks allocated before keep the old memory, it is freed with the last of them
+	struct _lc_memory *old = default_memory;
 
-	if((head = _find_list_element(config, name)) == NULL)
-		return LC_EF_NOT_EXISTS;
+	default_memory = memory;
+	_memory_unref(old);
 
-	return LC_EF_EXISTS;
+	return LC_SUCCESS;
 }
 
-int lc_set_variable(lc_config_t *config, const char *name, const char *new_value)
+int lc_set_allocator(lc_config_t *config, const lc_allocator_t *allocator)
 {
-	if(config == NULL || name == NULL || new_value == NULL)
+	if(config == NULL)
 	{
-		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
-
-		if(config != NULL)
-			config->error_type = LC_ERR_MEMORY_NO;
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
 		return LC_ERROR;
 	}
 
-	if(config->list == NULL)
+	if(allocator == NULL)
+		allocator = &default_memory->allocator;
+
+	if(allocator->alloc == NULL || allocator->realloc == NULL || allocator->free == NULL)
 	{
-		config->error_type = LC_ERR_EMPTY;
+		warning(stderr, "[WARNING] %s: allocator functions is null\n", __func__);
+		config->error_type = LC_ERR_MEMORY_NO;
 		return LC_ERROR;
 	}
 
-	if(_rewrite_list_element_value(config, name, new_value) != LC_SUCCESS)
+	struct _lc_memory *memory = _memory_create(allocator, config->memory->limit);
+	if(memory == NULL)
+	{
+		config->error_type = LC_ERR_MEMORY_NO;
 		return LC_ERROR;
+	}
+
+	// new blocks of an unshared table come from the new allocator too
+	if(config->table != NULL && config->table->refs == 1)
+		config->table->memory = memory;
 
+	// blocks allocated before are freed by the allocator they came from
+	_memory_release(config->memory);
+	config->memory = memory;
+
+	config->error_type = LC_ERR_NONE;
 	return LC_SUCCESS;
 }
 
-lc_config_variable_t* lc_get_variable(lc_config_t *config, const char *name)
+int lc_set_memory_limit(lc_config_t *config, size_t limit)
 {
-	if(config == NULL || name == NULL)
+	if(config == NULL)
 	{
-		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
-
-		if(config != NULL)
-			config->error_type = LC_ERR_MEMORY_NO;
-		return NULL;
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return LC_ERROR;
 	}
 
-	if(config->list == NULL)
-	{
-		config->error_type = LC_ERR_EMPTY;
-		return NULL;
-	}
+	config->memory->limit = limit;
 
-	struct _lc_config_list *head = NULL;
+	config->error_type = LC_ERR_NONE;
+	return LC_SUCCESS;
+}
 
-	if((head = _find_list_element(config, name)) == NULL)
-		return NULL;
+size_t lc_get_memory_usage(const lc_config_t *config)
+{
+	if(config == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return (size_t)0;
+	}
 
-	return _create_variable_copy(head->variable);
+	return config->memory->used;
 }
 
-int lc_replace_variable(lc_config_t *config, const char *name, lc_config_variable_t *variable)
+int lc_set_duplicate_policy(lc_config_t *config, lc_duplicates_t policy)
 {
-	if(config == NULL || name == NULL || variable == NULL)
+	if(config == NULL)
 	{
-		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
-
-		if(config != NULL)
-			config->error_type = LC_ERR_MEMORY_NO;
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
 		return LC_ERROR;
 	}
 
-	if(config->list == NULL)
+	if(policy < LC_DUP_COLLECT || policy > LC_DUP_ERROR)
 	{
-		config->error_type = LC_ERR_EMPTY;
+		warning(stderr, "[WARNING] %s: invalid policy\n", __func__);
 		return LC_ERROR;
 	}
 
-	struct _lc_config_list *head = NULL;
+	config->duplicates = policy;
+	return LC_SUCCESS;
+}
 
-	if((head = _find_list_element(config, name)) == NULL)
-		return LC_ERROR;
+unsigned int lc_get_abi_version(void)
+{
+	return LC_ABI_VERSION;
+}
 
-	lc_config_variable_t *variable_copy = NULL;
+lc_config_t* lc_create_config(const char *filepath, const char *delim, unsigned int abi_version)
+{
+	if(delim == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return NULL;
+	}
 
-	variable_copy = _create_variable_copy(variable);
-	if(variable_copy == NULL)
+	// the caller was compiled against another layout of the types
+	if(abi_version != LC_ABI_VERSION)
 	{
-		warning(stderr, "[WARNING] %s: _create_variable_copy failed\n", __func__);
-		config->error_type = LC_ERR_MEMORY_NO;
-		return LC_ERROR;
+		warning(stderr, "[WARNING] %s: abi version %u is not %u\n", __func__, abi_version, LC_ABI_VERSION);
+		return NULL;
 	}
 
-	_replace_variable_in_list(head, variable_copy);
+	lc_config_t *config = _memory_zalloc(NULL, sizeof(lc_config_t));
+	if(config == NULL)
+		return NULL;
 
-	return LC_SUCCESS;
+	if(lc_init_config(config, filepath, delim) == LC_ERROR)
+	{
+		_memory_free(config);
+		return NULL;
+	}
+
+	return config;
 }
 
-void lc_print_config(const lc_config_t *config)
+void lc_destroy_config(lc_config_t *config)
 {
 	if(config == NULL)
 	{
@@ -842,75 +7419,106 @@ void lc_print_config(const lc_config_t *config)
 		return;
 	}
 
-	if(config->list == NULL)
-		return;
-
-	_print_list(config->list);
+	lc_clear_config(config);
+	_memory_free(config);
 }
 
-char* lc_get_error(const lc_config_t *config)
+enum _lc_config_error lc_get_error_type(const lc_config_t *config)
 {
 	if(config == NULL)
 	{
 		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
-		return NULL;
-	}
-
-	if(config->error_type < 0 || config->error_type > 5)
-	{
-		warning(stderr, "[ERROR] %s: invalid error index\n", __func__);
-		return NULL;
+		return LC_ERR_NONE;
 	}
 
-	return _duplicate_string(error_msg[config->error_type]);
+	return config->error_type;
 }
 
-void lc_clear_config(lc_config_t *config)
+lc_duplicates_t lc_get_duplicate_policy(const lc_config_t *config)
 {
-	if(config == NULL) {
+	if(config == NULL)
+	{
 		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
-		return;
+		return LC_DUP_COLLECT;
 	}
 
-	_delete_list(config->list);
-
-	free(config->filepath);
-	free(config->delim);
-
-	config->list_size = 0;
-	config->error_type = LC_ERR_NONE;
-	config->filepath = NULL;
+	return config->duplicates;
 }
 
-char* lc_get_delim(lc_config_t *config)
+lc_iterator_t* lc_create_iterator(const lc_config_t *config, const char *prefix)
 {
-	if(config == NULL) {
+	if(config == NULL)
+	{
 		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
 		return NULL;
 	}
 
-	return _duplicate_string(config->delim);
+	lc_iterator_t *iterator = _memory_zalloc(NULL, sizeof(lc_iterator_t));
+	if(iterator == NULL)
+		return NULL;
+
+	if(prefix != NULL && prefix[0] != '\0')
+	{
+		if((iterator->prefix = _memory_duplicate_string(NULL, prefix)) == NULL)
+		{
+			_memory_free(iterator);
+			return NULL;
+		}
+
+		iterator->prefix_length = strlen(prefix);
+	}
+
+	iterator->config = config;
+	return iterator;
 }
 
-int lc_set_delim(lc_config_t *config, const char *delim)
+int lc_iterator_next(lc_iterator_t *iterator, const char **name, const char **value)
 {
-	if(config == NULL || delim == NULL) {
+	if(iterator == NULL || name == NULL || value == NULL)
+	{
 		warning(stderr, "[WARNING] %s: arguments is null\n", __func__);
-
-		if(config != NULL)
-			config->error_type = LC_ERR_MEMORY_NO;
 		return LC_ERROR;
 	}
 
-	free(config->delim);
+	// the table is taken on every step, it is replaced when a shared config is changed
+	const struct _lc_config_table *table = iterator->config->table;
+	if(table == NULL)
+		return 0;
 
-	if((config->delim = _duplicate_string(delim)) == NULL)
+	while(iterator->index < table->count)
 	{
-		config->error_type = LC_ERR_MEMORY_NO;
-		return LC_ERROR;
+		size_t index = iterator->index++;
+
+		if(!_table_is_live(table, index))
+			continue;
+
+		const char *entry_name = _table_name(table, index);
+
+		if(iterator->prefix_length != 0 && strncmp(entry_name, iterator->prefix, iterator->prefix_length) != 0)
+			continue;
+
+		const char *entry_value = _lookup_value(iterator->config, index);
+		if(entry_value == NULL)
+			return LC_ERROR;
+
+		*name = entry_name;
+		*value = entry_value;
+		return 1;
 	}
 
-	return LC_SUCCESS;
+	return 0;
+}
+
+void lc_destroy_iterator(lc_iterator_t *iterator)
+{
+	if(iterator == NULL)
+	{
+		warning(stderr, "[WARNING] %s: argument is null\n", __func__);
+		return;
+	}
+
+	_memory_free(iterator->prefix);
+	_memory_free(iterator);
 }
 
 size_t lc_get_size(const lc_config_t *config)
@@ -920,7 +7528,7 @@ size_t lc_get_size(const lc_config_t *config)
 		return (size_t)0;
 	}
 
-	return config->list_size;
+	return config->size;
 }
 
 char* lc_get_path(const lc_config_t *config)
@@ -945,14 +7553,16 @@ int lc_set_path(lc_config_t *config, const char *filepath)
 		return LC_ERROR;
 	}
 
-	free(config->filepath);
-
-	if((config->filepath = _duplicate_string(filepath)) == NULL)
+	char *new_filepath = _memory_duplicate_string(config->memory, filepath);
+	if(new_filepath == NULL)
 	{
 		config->error_type = LC_ERR_MEMORY_NO;
 		return LC_ERROR;
 	}
 
+	_memory_free(config->filepath);
+	config->filepath = new_filepath;
+
 	return LC_SUCCESS;
 }
 
@@ -963,7 +7573,7 @@ void lc_clear_path(lc_config_t *config)
 		return;
 	}
 
-	free(config->filepath);
+	_memory_free(config->filepath);
 	config->filepath = NULL;
 }
 
@@ -974,7 +7584,7 @@ lc_config_variable_t* lc_create_variable(const char *name, const char *value)
 		return NULL;
 	}
 
-	return _make_config_variable(name, value);
+	return _make_config_variable(NULL, name, value);
 }
 
 lc_config_variable_t* lc_create_variable_copy(lc_config_variable_t *variable)
@@ -984,7 +7594,7 @@ lc_config_variable_t* lc_create_variable_copy(lc_config_variable_t *variable)
 		return NULL;
 	}
 
-	return _create_variable_copy(variable);
+	return _create_variable_copy(NULL, variable);
 }
 
 void lc_destroy_variable(lc_config_variable_t *variable)
@@ -1024,8 +7634,12 @@ int lc_set_variable_name(lc_config_variable_t *variable, const char *name)
 		return LC_ERROR;
 	}
 
-	free(variable->name);
-	variable->name = _duplicate_string(name);
+	char *new_name = _memory_duplicate_string(_memory_of(variable), name);
+	if(new_name == NULL)
+		return LC_ERROR;
+
+	_memory_free(variable->name);
+	variable->name = new_name;
 
 	return LC_SUCCESS;
 }
@@ -1037,8 +7651,12 @@ int lc_set_variable_value(lc_config_variable_t *variable, const char *value)
 		return LC_ERROR;
 	}
 
-	free(variable->value);
-	variable->value = _duplicate_string(value);
+	char *new_value = _memory_duplicate_string(_memory_of(variable), value);
+	if(new_value == NULL)
+		return LC_ERROR;
+
+	_memory_free(variable->value);
+	variable->value = new_value;
 
 	return LC_SUCCESS;
 }